@@ -0,0 +1,96 @@
+/**
+ * @file linux_main.c
+ * @brief Example endpoint simulator for Linux hosts.
+ *
+ * Runs one MCTP endpoint on each serial device named on the command line
+ * (real ttys or pty slaves) from a single epoll loop.  Unlike the polling
+ * loop of main.c, the process sleeps until a device is readable or, while a
+ * response is held up, writable.
+ *
+ * Usage: mctp_linux_endpoint [-b baud] device...
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mctp.h"
+#include "mctp_linux.h"
+
+/* most devices served by one process */
+#define MAX_PORTS 64
+
+static mctp_endpoint_t endpoints[MAX_PORTS];
+static mctp_linux_port_t ports[MAX_PORTS];
+
+/**
+ * @brief Program entry point.
+ *
+ * @param argc Argument count.
+ * @param argv Optional `-b baud`, then one or more device paths.
+ * @return int 1 when a device cannot be set up or the loop fails, 0 once every device hung up.
+ */
+int main(int argc, char** argv) {
+    uint32_t baud = 0;
+    int first = 1;
+    if ((argc > 2) && (strcmp(argv[1], "-b") == 0)) {
+        baud = (uint32_t)strtoul(argv[2], NULL, 10);
+        first = 3;
+    }
+    int count = argc - first;
+    if ((count < 1) || (count > MAX_PORTS)) {
+        fprintf(stderr, "usage: %s [-b baud] device... (up to %d devices)\n", argv[0], MAX_PORTS);
+        return 1;
+    }
+
+    int epoll_fd = mctp_linux_loop_create();
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        const char* path = argv[first + i];
+        if ((mctp_linux_open(&ports[i], path, baud) < 0) ||
+            (mctp_linux_add(epoll_fd, &ports[i], &endpoints[i], NULL) < 0)) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    int open_ports = count;
+    while (open_ports > 0) {
+        if (mctp_linux_poll(epoll_fd, -1) < 0) {
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (ports[i].hangup && (ports[i].fd >= 0)) {
+                fprintf(stderr, "%s hung up\n", argv[first + i]);
+                mctp_linux_close(&ports[i]);
+                open_ports--;
+            }
+        }
+    }
+    return 0;
+}
@@ -28,8 +28,14 @@
  * SOFTWARE.
  */
 
+#ifndef MCTP_H
+#define MCTP_H
+
 #include <stdint.h>
 
+/* One MCTP endpoint on one serial link; see the end of this file. */
+typedef struct mctp_endpoint mctp_endpoint_t;
+
 /* control message codes */
 #define CONTROL_MSG_SET_ENDPOINT_ID 0x01
 #define CONTROL_MSG_GET_ENDPOINT_ID 0x02
@@ -46,7 +52,107 @@
 #define CONTROL_COMPLETE_COMMAND_SPECIFIC_START 0x80
 #define CONTROL_COMPLETE_COMMAND_SPECIFIC_END 0xFF
 
-/* function declarations */
+/* Control commands are dispatched through `mctp_control_handlers`, a constant
+ * table indexed by command code, shared by all endpoints.  A handler is called
+ * with the endpoint holding the request in its packet buffer (see
+ * mctp_get_request_ctx()) and must answer it with mctp_send_response_ctx() or
+ * release it with mctp_ignore_packet_ctx();
+ * codes without a handler, or at or above MCTP_CONTROL_COMMANDS, are answered
+ * with CONTROL_COMPLETE_UNSUPPORTED_CMD.  The core's table is a weak
+ * definition holding MCTP_CONTROL_STANDARD_HANDLERS; an application adds
+ * commands by defining the table itself, with no change to the core:
+ *
+ *     const mctp_control_handler_t mctp_control_handlers[MCTP_CONTROL_COMMANDS] = {
+ *         MCTP_CONTROL_STANDARD_HANDLERS,
+ *         [0x0B] = my_command_handler,
+ *     };
+ *
+ * The Get Message Type Support response lists every code with a handler.
+ */
+#ifndef MCTP_CONTROL_COMMANDS
+#define MCTP_CONTROL_COMMANDS 0x20
+#endif
+
+typedef void (*mctp_control_handler_t)(mctp_endpoint_t* ep);
+extern const mctp_control_handler_t mctp_control_handlers[MCTP_CONTROL_COMMANDS];
+
+void process_set_endpoint_id_control_message(mctp_endpoint_t* ep);
+void process_get_endpoint_id_control_message(mctp_endpoint_t* ep);
+void process_get_mctp_version_support_control_message(mctp_endpoint_t* ep);
+void process_get_message_type_support_control_message(mctp_endpoint_t* ep);
+
+#define MCTP_CONTROL_STANDARD_HANDLERS                                                         \
+    [CONTROL_MSG_SET_ENDPOINT_ID] = process_set_endpoint_id_control_message,                   \
+    [CONTROL_MSG_GET_ENDPOINT_ID] = process_get_endpoint_id_control_message,                   \
+    [CONTROL_MSG_GET_MCTP_VERSION_SUPPORT] = process_get_mctp_version_support_control_message, \
+    [CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT] = process_get_message_type_support_control_message
+
+/* Largest packet this endpoint handles, counted like the serial binding's
+ * byte count field (transport header plus payload).  Every MCTP endpoint
+ * supports the baseline of 64; endpoints with RAM to spare can be built with
+ * up to 255, the largest byte count the serial binding can carry.  Each packet
+ * buffer is MCTP_TRANSMISSION_UNIT + 6 bytes.  Received packets up to this
+ * size are always accepted, while multi-packet messages are sent with the
+ * baseline until mctp_set_transmission_unit() raises it for a peer known to
+ * accept larger packets.
+ */
+#define BASELINE_TRANSMISSION_UNIT 64
+#ifndef MCTP_TRANSMISSION_UNIT
+#define MCTP_TRANSMISSION_UNIT BASELINE_TRANSMISSION_UNIT
+#endif
+#define MCTP_BUFFER_SIZE (MCTP_TRANSMISSION_UNIT + 6)  // add space for framing bytes and header
+
+/* Supplies `len` message bytes starting at `offset` into `dst` (see mctp_send_message_cb()). */
+typedef void (*mctp_message_source_t)(void* ctx, uint16_t offset, uint8_t* dst, uint16_t len);
+
+/* Serial link and clock of one endpoint.  Every call gets the `platform`
+ * argument given to mctp_init_ctx(), so one set of functions can drive many
+ * ports.  `read` and `write` must not block and return the number of bytes
+ * moved (0 when none); `init` and `millis` may be NULL (no setup, and a clock
+ * that never advances).
+ */
+typedef struct {
+    void (*init)(void* platform);
+    uint16_t (*read)(void* platform, uint8_t* buf, uint16_t max);
+    uint16_t (*write)(void* platform, const uint8_t* buf, uint16_t len);
+    uint32_t (*millis)(void* platform);
+} mctp_platform_ops_t;
+
+/* function declarations: each acts on the endpoint passed as `ep` */
+void mctp_init_ctx(mctp_endpoint_t* ep, const mctp_platform_ops_t* ops, void* platform);
+void mctp_update_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_is_packet_available_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_is_control_packet_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_is_pldm_packet_ctx(mctp_endpoint_t* ep);
+void mctp_process_control_message_ctx(mctp_endpoint_t* ep);
+void mctp_ignore_packet_ctx(mctp_endpoint_t* ep);
+uint8_t* mctp_get_request_ctx(mctp_endpoint_t* ep, uint16_t* len);
+int mctp_send_response_ctx(mctp_endpoint_t* ep, uint16_t len);
+uint16_t mctp_send_frame_ctx(mctp_endpoint_t* ep);
+int mctp_send_event_ctx(mctp_endpoint_t* ep, const uint8_t* data, uint16_t len);
+uint8_t* mctp_event_reserve_ctx(mctp_endpoint_t* ep, uint16_t len);
+int mctp_event_commit_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t msg_tag);
+uint8_t mctp_is_event_queue_empty_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_event_queue_high_water_ctx(mctp_endpoint_t* ep);
+uint32_t mctp_event_queue_drops_ctx(mctp_endpoint_t* ep);
+uint32_t mctp_get_sync_discards_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_rx_queue_high_water_ctx(mctp_endpoint_t* ep);
+uint32_t mctp_rx_queue_drops_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_is_message_available_ctx(mctp_endpoint_t* ep);
+const uint8_t* mctp_get_message_ctx(mctp_endpoint_t* ep, uint16_t* len, uint8_t* src_eid,
+                                    uint8_t* tag);
+void mctp_release_message_ctx(mctp_endpoint_t* ep);
+int mctp_send_message_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t tag, const uint8_t* msg,
+                          uint16_t len);
+int mctp_send_message_cb_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t tag, uint16_t len,
+                             mctp_message_source_t source, void* ctx);
+uint8_t mctp_is_message_sending_ctx(mctp_endpoint_t* ep);
+int mctp_set_transmission_unit_ctx(mctp_endpoint_t* ep, uint16_t unit);
+uint16_t mctp_get_transmission_unit_ctx(mctp_endpoint_t* ep);
+uint8_t mctp_get_endpoint_id_ctx(mctp_endpoint_t* ep);
+
+/* The same functions acting on `mctp_default_endpoint`, whose platform ops are
+ * the platform_*() functions of platform.h (src/mctp_default.c). */
 void mctp_init(void);
 void mctp_update(void);
 uint8_t mctp_is_packet_available(void);
@@ -54,22 +160,315 @@ uint8_t mctp_is_control_packet(void);
 uint8_t mctp_is_pldm_packet(void);
 void mctp_process_control_message(void);
 void mctp_ignore_packet(void);
+uint8_t* mctp_get_request(uint16_t* len);
+int mctp_send_response(uint16_t len);
+uint16_t mctp_send_frame(void);
 int mctp_send_event(const uint8_t* data, uint16_t len);
+uint8_t* mctp_event_reserve(uint16_t len);
+int mctp_event_commit(uint8_t dest_eid, uint8_t msg_tag);
 uint8_t mctp_is_event_queue_empty(void);
+uint8_t mctp_event_queue_high_water(void);
+uint32_t mctp_event_queue_drops(void);
+uint32_t mctp_get_sync_discards(void);
+uint8_t mctp_rx_queue_high_water(void);
+uint32_t mctp_rx_queue_drops(void);
+uint8_t mctp_is_message_available(void);
+const uint8_t* mctp_get_message(uint16_t* len, uint8_t* src_eid, uint8_t* tag);
+void mctp_release_message(void);
+int mctp_send_message(uint8_t dest_eid, uint8_t tag, const uint8_t* msg, uint16_t len);
+int mctp_send_message_cb(uint8_t dest_eid, uint8_t tag, uint16_t len,
+                         mctp_message_source_t source, void* ctx);
+uint8_t mctp_is_message_sending(void);
+int mctp_set_transmission_unit(uint16_t unit);
+uint16_t mctp_get_transmission_unit(void);
+uint8_t mctp_get_endpoint_id(void);
 
-/* Compile-time option to enable a single prioritized event TX slot.
- * Set to 1 to enable an extra TX buffer for endpoint-originated datagrams.
- * When enabled the event slot is preferred at frame boundaries (no byte
- * interleaving of frames is performed). Default is disabled (0).
+/* Compile-time option to enable the prioritized event TX queue.
+ * Set to 1 to queue endpoint-originated datagrams for transmission.  Queued
+ * events and the primary response are scheduled at frame boundaries according
+ * to MCTP_TX_SCHED (no byte interleaving of frames is performed). Default is
+ * disabled (0).
  */
 #ifndef MCTP_EVENT_TX_ENABLED
 #define MCTP_EVENT_TX_ENABLED 0
 #endif
 
-/* Size of the event TX buffer when enabled. Defaults to the main MCTP buffer
- * size; can be overridden at compile time. */
+/* Largest single event frame accepted by mctp_send_event(); can be overridden
+ * at compile time. */
 #ifndef MCTP_EVENT_TX_BUF_SIZE
 #define MCTP_EVENT_TX_BUF_SIZE 128
 #endif
 
+/* Maximum number of events queued at once when events are enabled. */
+#ifndef MCTP_EVENT_QUEUE_DEPTH
+#define MCTP_EVENT_QUEUE_DEPTH 8
+#endif
+
+/* Bytes of RAM shared by all queued event frames.  Frames are packed back to
+ * back, so the arena holds MCTP_EVENT_QUEUE_DEPTH events of up to
+ * MCTP_EVENT_ARENA_SIZE / MCTP_EVENT_QUEUE_DEPTH bytes (32 by default), or
+ * fewer larger ones.  Must be at least MCTP_EVENT_TX_BUF_SIZE. */
+#ifndef MCTP_EVENT_ARENA_SIZE
+#define MCTP_EVENT_ARENA_SIZE 256
+#endif
+
+/* Transmit scheduling policies, applied at frame boundaries when both a
+ * queued event and the primary response are ready:
+ * - MCTP_TX_SCHED_STRICT: events always go first (the response can starve
+ *   under a steady event flow).
+ * - MCTP_TX_SCHED_ROUND_ROBIN: events and responses alternate.
+ * - MCTP_TX_SCHED_DEADLINE: events go first only while the response stays
+ *   within its latency budget, MCTP_TX_RESPONSE_BUDGET.
+ */
+#define MCTP_TX_SCHED_STRICT 0
+#define MCTP_TX_SCHED_ROUND_ROBIN 1
+#define MCTP_TX_SCHED_DEADLINE 2
+
+/* Transmit scheduling policy when events are enabled.  Default is strict
+ * priority (MCTP_TX_SCHED_STRICT). */
+#ifndef MCTP_TX_SCHED
+#define MCTP_TX_SCHED MCTP_TX_SCHED_STRICT
+#endif
+
+/* Deadline policy only: frame bytes of queued events that may be sent while a
+ * response is waiting.  An event that would take the response past the
+ * budget is held back until the response has been sent.  The budget is in
+ * bytes rather than time since the wire time of a frame is proportional to
+ * its length; a frame already on the wire when the response becomes ready is
+ * not counted.  0 makes responses strictly first. */
+#ifndef MCTP_TX_RESPONSE_BUDGET
+#define MCTP_TX_RESPONSE_BUDGET 140
+#endif
+
+/* Compile-time option to escape the primary response once, into a dedicated
+ * staging buffer, when its transmission starts.  The send loop then copies the
+ * on-wire image without classifying header/payload/trailer bytes.  Costs
+ * 2 * MCTP_BUFFER_SIZE bytes of RAM (140 bytes with the baseline transmission
+ * unit); pays off mostly for escape-dense payloads (see bench_tx in `make bench`).
+ * Default is disabled (0).
+ */
+#ifndef MCTP_TX_STAGING_ENABLED
+#define MCTP_TX_STAGING_ENABLED 0
+#endif
+
+/* Compile-time option for full-duplex operation.  A response handed to
+ * mctp_send_frame() is moved to its own transmit buffer as soon as the previous
+ * response has left it, and the receiver goes back to waiting for the next
+ * frame while the response drains.  Bytes after a complete frame are held
+ * (and left in the platform) until the application has handled the frame,
+ * instead of being discarded, so pipelined requests are not lost.  Costs
+ * MCTP_BUFFER_SIZE + MCTP_RX_CHUNK_SIZE bytes of RAM.  Default is disabled (0).
+ */
+#ifndef MCTP_FULL_DUPLEX_ENABLED
+#define MCTP_FULL_DUPLEX_ENABLED 0
+#endif
+
+/* Number of complete received frames that can wait for the application.
+ * With 0 (the default) a frame arriving while the previous one is being
+ * handled is discarded.  Otherwise frames are assembled into a queue of
+ * MCTP_RX_QUEUE_DEPTH + 1 slots of MCTP_BUFFER_SIZE bytes (one slot is always
+ * free for assembly) and handed to the application, in order, through
+ * mctp_buffer; frames arriving while the queue is full are counted by
+ * mctp_rx_queue_drops().
+ */
+#ifndef MCTP_RX_QUEUE_DEPTH
+#define MCTP_RX_QUEUE_DEPTH 0
+#endif
+
+/* Maximum number of bytes requested from platform_serial_read() on each
+ * mctp_update() call.  The chunk lives on the stack; match it to the depth of
+ * the UART FIFO or DMA buffer. */
+#ifndef MCTP_RX_CHUNK_SIZE
+#define MCTP_RX_CHUNK_SIZE 16
+#endif
+
+/* Compile-time option to receive through a lock-free SPSC ring instead of
+ * platform_serial_read().  The platform's UART interrupt (or DMA callback)
+ * pushes bytes with mctp_ring_put()/mctp_ring_write() on `mctp_rx_ring`, and
+ * mctp_update() drains it in chunks.  The ring is initialized by mctp_init()
+ * before platform_init() runs.  Default is disabled (0).
+ */
+#ifndef MCTP_RX_RING_ENABLED
+#define MCTP_RX_RING_ENABLED 0
+#endif
+
+/* Size of the receive ring when enabled; must be a power of two. */
+#ifndef MCTP_RX_RING_SIZE
+#define MCTP_RX_RING_SIZE 128
+#endif
+
+#if MCTP_RX_RING_ENABLED
+#include "mctp_ring.h"
+#endif
+
+/* Compile-time option to reassemble multi-packet messages.  Received packets
+ * without both SOM and EOM set are collected by (source EID, TO, tag) in
+ * `mctp_rx_reasm` (see include/mctp_reasm.h for its sizing knobs) instead of
+ * being reported by mctp_is_packet_available(); completed messages are read
+ * with mctp_get_message() and freed with mctp_release_message().  Timeouts use
+ * platform_millis().  Without MCTP_RX_QUEUE_DEPTH, the receiver also holds the
+ * bytes following an absorbed packet (MCTP_RX_CHUNK_SIZE bytes of RAM) so that
+ * packets arriving back to back are not lost.  Default is disabled (0).
+ */
+#ifndef MCTP_REASSEMBLY_ENABLED
+#define MCTP_REASSEMBLY_ENABLED 0
+#endif
+
+#if MCTP_REASSEMBLY_ENABLED
+#include "mctp_reasm.h"
+#endif
+
+/* Compile-time option to send messages longer than one packet.
+ * mctp_send_message() and mctp_send_message_cb() split a message into packets
+ * of up to MCTP_BUFFER_SIZE - 10 message bytes with SOM, EOM and packet
+ * sequence numbers set, and each packet is built (and its FCS computed) only
+ * when the scheduler is ready to transmit it, so the message is read from the
+ * caller's buffer or callback one packet at a time.  Packets are scheduled as
+ * responses (see MCTP_TX_SCHED).  Costs MCTP_BUFFER_SIZE bytes of RAM for the
+ * packet being sent.  Default is disabled (0).
+ */
+#ifndef MCTP_FRAGMENTATION_ENABLED
+#define MCTP_FRAGMENTATION_ENABLED 0
+#endif
+
+/* Compile-time option to answer the constant control responses (Get MCTP
+ * Version Support, Get Message Type Support) from templates prepared by
+ * mctp_init(), with the FCS of each constant body cached: per response only
+ * the header bytes are run through calc_fcs(), and the cached part is folded
+ * in with 16 XORs at most.  The templates are built into each endpoint, so
+ * endpoints share no mutable state; this costs about 40 bytes of RAM per
+ * template plus MCTP_CONTROL_COMMANDS + 2 for the message type list, per
+ * endpoint.  Default is disabled (0).
+ */
+#ifndef MCTP_RESPONSE_TEMPLATES_ENABLED
+#define MCTP_RESPONSE_TEMPLATES_ENABLED 0
+#endif
+
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+/* A constant control response with the FCS contribution of its command code
+ * and body cached (see response_template_init() in src/mctp.c) */
+struct mctp_response_template {
+    const uint8_t* body;  // response bytes from the completion code on
+    uint8_t len;          // number of body bytes
+    uint16_t partial;     // FCS of the command code and body from a zero register
+    uint16_t shift[16];   // register bit i carried across the same number of zero bytes
+};
+#endif
+
+/* Send progress of one logical (unescaped) frame, resumable across calls */
+struct mctp_tx_cursor {
+    const uint8_t* buf;     // frame being transmitted
+    uint16_t len;           // frame length
+    uint16_t idx;           // next frame byte to transmit
+    uint16_t escape_end;    // payload bytes [3, escape_end) are escaped on the wire
+    uint8_t escape_pending; // ESCAPE_CHAR sent, pending_byte still owed
+    uint8_t pending_byte;   // second byte of an interrupted escape pair
+};
+
+/* One queued event frame in the event arena */
+struct mctp_event_entry {
+    uint16_t offset;   // start of the frame in event_arena
+    uint16_t len;      // frame length
+    uint8_t committed; // 0 while reserved by mctp_event_reserve() and not yet committed
+};
+
+/* Message being sent by mctp_send_message() */
+struct mctp_tx_message {
+    const uint8_t* data;          // message bytes, or NULL when read through `source`
+    mctp_message_source_t source; // callback supplying the message bytes
+    void* ctx;                    // argument passed to `source`
+    uint16_t len;                 // message length
+    uint16_t offset;              // message bytes already placed in packets
+    uint8_t dest_eid;             // destination endpoint
+    uint8_t tag;                  // tag owner bit and message tag
+    uint8_t seq;                  // packet sequence number of the next packet
+    uint8_t active;               // a message is being sent
+};
+
+/* All state of one endpoint.  The members are private to src/mctp.c; the
+ * struct is defined here only so that applications can allocate endpoints
+ * statically, one per serial port.  Its size follows the compile-time
+ * options above, which apply to every endpoint of the program.
+ */
+struct mctp_endpoint {
+    const mctp_platform_ops_t* ops; // serial link and clock
+    void* platform;                 // argument passed to every `ops` call
+    uint8_t endpoint_id;            // 0 while unprogrammed
+    uint8_t rx_state;               // current framer state
+    uint8_t byte_count;             // body bytes left to receive for current frame
+    uint8_t current_tx_slot;        // 0 none, 1 response, 2 event, 3 message packet
+    uint16_t buffer_idx;            // index into the receive buffer
+    uint16_t rx_fcs;                // running FCS of the frame being received
+    uint16_t tx_unit;               // packet size used when sending messages
+    uint32_t sync_discards;         // bytes skipped while hunting for FRAME_CHAR
+    uint8_t buffer[MCTP_BUFFER_SIZE]; // transmission/reception buffer
+    struct mctp_tx_cursor tx_primary;
+#if MCTP_TX_STAGING_ENABLED
+    uint8_t tx_staging[2 * MCTP_BUFFER_SIZE]; // pre-escaped image of the primary response
+#endif
+#if MCTP_EVENT_TX_ENABLED
+    uint8_t event_arena[MCTP_EVENT_ARENA_SIZE];
+    struct mctp_event_entry event_queue[MCTP_EVENT_QUEUE_DEPTH];
+    uint8_t event_head;             // oldest queued event (transmitted first)
+    uint8_t event_count;            // queued events, including the one being transmitted
+    uint16_t event_arena_next;      // arena offset following the newest event
+    uint8_t event_high_water;       // most events ever queued at once
+    uint8_t event_reserved;         // a reservation is outstanding
+    uint8_t event_reserved_entry;   // queue entry held by the reservation
+    uint8_t tx_last_slot;           // round robin: slot of the most recently started frame
+    uint16_t tx_response_waited;    // deadline: event bytes sent while the response was pending
+    uint32_t event_drops;           // events refused because the queue was full
+    struct mctp_tx_cursor tx_event;
+#endif
+#if MCTP_FRAGMENTATION_ENABLED
+    struct mctp_tx_message tx_msg;
+    uint8_t tx_msg_packet[MCTP_BUFFER_SIZE]; // packet currently on the wire
+    struct mctp_tx_cursor tx_fragment;
+#endif
+#if MCTP_FULL_DUPLEX_ENABLED
+    uint8_t tx_response[MCTP_BUFFER_SIZE]; // response moved out of `buffer`
+    uint8_t tx_response_pending;    // tx_response holds a frame not yet fully sent
+#endif
+#if !MCTP_RX_QUEUE_DEPTH && (MCTP_FULL_DUPLEX_ENABLED || MCTP_REASSEMBLY_ENABLED)
+    uint8_t rx_chunk[MCTP_RX_CHUNK_SIZE]; // received bytes held across mctp_update() calls
+    uint16_t rx_chunk_len;
+    uint16_t rx_chunk_pos;
+#endif
+#if MCTP_RX_QUEUE_DEPTH
+    uint8_t rx_slots[MCTP_RX_QUEUE_DEPTH + 1][MCTP_BUFFER_SIZE];
+    uint16_t rx_slot_len[MCTP_RX_QUEUE_DEPTH + 1];
+    uint8_t rx_queue_head;          // oldest completed frame
+    uint8_t rx_queue_tail;          // slot being assembled
+    uint8_t rx_queue_count;         // completed frames waiting for the application
+    uint8_t rx_queue_high_water;    // most completed frames ever waiting at once
+    uint32_t rx_queue_drops;        // frames dropped because the queue was full
+    uint8_t rx_framer_state;        // receive state machine, independent of rx_state
+    uint16_t rx_framer_idx;         // index into the slot being assembled
+#endif
+#if MCTP_RX_RING_ENABLED
+    uint8_t rx_ring_storage[MCTP_RX_RING_SIZE];
+    mctp_ring_t rx_ring;            // filled by the platform's UART interrupt
+#endif
+#if MCTP_REASSEMBLY_ENABLED
+    mctp_reasm_t rx_reasm;
+    uint8_t reasm_current;          // message returned by mctp_get_message()
+#endif
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+    struct mctp_response_template version_template;
+    struct mctp_response_template version_unsupported_template;
+    struct mctp_response_template message_types_template;
+    uint8_t message_types_body[MCTP_CONTROL_COMMANDS + 2];
+#endif
+};
+
+/* The endpoint behind the functions without a _ctx suffix, and the names its
+ * receive ring and reassembly state have always had. */
+extern mctp_endpoint_t mctp_default_endpoint;
+#if MCTP_RX_RING_ENABLED
+#define mctp_rx_ring (mctp_default_endpoint.rx_ring)
+#endif
+#if MCTP_REASSEMBLY_ENABLED
+#define mctp_rx_reasm (mctp_default_endpoint.rx_reasm)
+#endif
 
+#endif /* MCTP_H */
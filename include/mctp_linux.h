@@ -0,0 +1,70 @@
+/**
+ * @file mctp_linux.h
+ * @brief Linux serial backend: endpoints on tty or pty devices, run from an epoll loop.
+ *
+ * Each port wraps one non-blocking file descriptor and supplies the
+ * mctp_platform_ops_t of the endpoint attached to it.  A port asks epoll for
+ * readability, or only for writability while the device refuses transmitted
+ * bytes, so mctp_linux_poll() sleeps in the kernel until a port can make progress
+ * and an idle endpoint costs no CPU time.  When woken, a port runs its
+ * endpoint (mctp_update_ctx() and the packet handler) until nothing more can
+ * be read or written.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MCTP_LINUX_H
+#define MCTP_LINUX_H
+
+#include <stdint.h>
+
+#include "mctp.h"
+
+/* Handles what the endpoint has received, after every mctp_update_ctx().  It
+ * must answer or release a waiting packet (and a reassembled message) before
+ * returning; a packet left waiting stops the receiver. */
+typedef void (*mctp_linux_handler_t)(mctp_endpoint_t* ep);
+
+typedef struct {
+    int fd;                       /* serial device, non-blocking */
+    int epoll_fd;                 /* loop the port belongs to, -1 when none */
+    mctp_endpoint_t* ep;          /* endpoint run on the port */
+    mctp_linux_handler_t handler; /* NULL: answer control requests, drop the rest */
+    uint32_t events;              /* epoll events currently requested */
+    uint32_t moved;               /* bytes read plus bytes written, to detect progress */
+    uint8_t tx_blocked;           /* the device refused bytes; wait for writability */
+    uint8_t hangup;               /* the device hung up; the port has left its loop */
+} mctp_linux_port_t;
+
+/* platform ops of every port; the `platform` argument is the mctp_linux_port_t */
+extern const mctp_platform_ops_t mctp_linux_ops;
+
+int mctp_linux_open(mctp_linux_port_t* port, const char* path, uint32_t baud);
+int mctp_linux_attach(mctp_linux_port_t* port, int fd, uint32_t baud);
+void mctp_linux_close(mctp_linux_port_t* port);
+int mctp_linux_loop_create(void);
+int mctp_linux_add(int epoll_fd, mctp_linux_port_t* port, mctp_endpoint_t* ep,
+                   mctp_linux_handler_t handler);
+void mctp_linux_service(mctp_linux_port_t* port);
+int mctp_linux_poll(int epoll_fd, int timeout_ms);
+
+#endif /* MCTP_LINUX_H */
@@ -0,0 +1,99 @@
+/**
+ * @file mctp_reasm.h
+ * @brief Reassembly of multi-packet MCTP messages.
+ *
+ * Packets of a message are collected by (source EID, tag owner bit, tag) in
+ * one of `MCTP_REASM_MESSAGES` fixed regions of `MCTP_REASM_MAX_MESSAGE`
+ * bytes.  The packet carrying SOM opens a message, later packets must follow
+ * in packet sequence order, and the packet carrying EOM completes it.  A
+ * completed message stays in its region until released.  Messages that stop
+ * making progress are dropped after `MCTP_REASM_TIMEOUT_MS`, or evicted
+ * (oldest first) when a new message finds no free region.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MCTP_REASM_H
+#define MCTP_REASM_H
+
+#include <stdint.h>
+
+/* Number of messages that can be reassembled (or held complete) at once. */
+#ifndef MCTP_REASM_MESSAGES
+#define MCTP_REASM_MESSAGES 2
+#endif
+
+/* Largest reassembled message, counted from the message type byte.  The
+ * arena is MCTP_REASM_MESSAGES * MCTP_REASM_MAX_MESSAGE bytes. */
+#ifndef MCTP_REASM_MAX_MESSAGE
+#define MCTP_REASM_MAX_MESSAGE 256
+#endif
+
+/* A message with no new packet for this long is dropped (see mctp_reasm_expire()). */
+#ifndef MCTP_REASM_TIMEOUT_MS
+#define MCTP_REASM_TIMEOUT_MS 100
+#endif
+
+/* transport header flag bits (byte 3 of the MCTP transport header) */
+#define MCTP_FLAG_SOM 0x80
+#define MCTP_FLAG_EOM 0x40
+#define MCTP_FLAG_SEQ_SHIFT 4
+#define MCTP_FLAG_SEQ_MASK 0x30
+#define MCTP_FLAG_TO 0x08
+#define MCTP_FLAG_TAG_MASK 0x07
+
+/* mctp_reasm_packet() results */
+#define MCTP_REASM_PENDING 0     /* packet absorbed, message not complete yet */
+#define MCTP_REASM_COMPLETE 1    /* packet completed a message */
+#define MCTP_REASM_NO_ROOM (-1)  /* no region free for a new message; packet dropped */
+#define MCTP_REASM_SEQUENCE (-2) /* out-of-sequence packet; message dropped */
+#define MCTP_REASM_TOO_LONG (-3) /* message exceeds MCTP_REASM_MAX_MESSAGE; message dropped */
+#define MCTP_REASM_UNKNOWN (-4)  /* middle/end packet of no message in progress; dropped */
+
+typedef struct {
+    uint8_t state;     /* free, assembling or complete */
+    uint8_t src_eid;   /* source endpoint of the message */
+    uint8_t tag;       /* tag owner bit and message tag, as in the transport flags */
+    uint8_t next_seq;  /* packet sequence number expected next */
+    uint16_t len;      /* message bytes collected so far */
+    uint16_t age;      /* order in which messages were opened, for eviction */
+    uint32_t last_ms;  /* time of the most recent packet */
+} mctp_reasm_msg_t;
+
+typedef struct {
+    mctp_reasm_msg_t msgs[MCTP_REASM_MESSAGES];
+    uint8_t arena[MCTP_REASM_MESSAGES][MCTP_REASM_MAX_MESSAGE];
+    uint16_t next_age;
+    uint32_t sequence_errors; /* messages dropped for a missing or repeated packet */
+    uint32_t timeouts;        /* messages dropped by mctp_reasm_expire() */
+    uint32_t drops;           /* stray packets; messages refused, evicted or too long */
+} mctp_reasm_t;
+
+void mctp_reasm_init(mctp_reasm_t* r);
+int mctp_reasm_packet(mctp_reasm_t* r, uint8_t src_eid, uint8_t flags, const uint8_t* payload,
+                      uint16_t len, uint32_t now_ms, uint8_t* msg_index);
+uint8_t mctp_reasm_is_open(const mctp_reasm_t* r, uint8_t src_eid, uint8_t flags);
+const uint8_t* mctp_reasm_message(const mctp_reasm_t* r, uint8_t msg_index, uint16_t* len);
+void mctp_reasm_release(mctp_reasm_t* r, uint8_t msg_index);
+uint8_t mctp_reasm_expire(mctp_reasm_t* r, uint32_t now_ms);
+
+#endif /* MCTP_REASM_H */
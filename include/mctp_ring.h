@@ -0,0 +1,84 @@
+/**
+ * @file mctp_ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring.
+ *
+ * Hands received bytes from a UART interrupt handler or DMA completion
+ * callback (the producer) to the framer running in the main loop (the
+ * consumer) without disabling interrupts.  The producer only writes `head`,
+ * the consumer only writes `tail`; both indices run freely and are masked
+ * on access, so the ring holds exactly `size` bytes.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MCTP_RING_H
+#define MCTP_RING_H
+
+#include <stdint.h>
+
+/* Index type shared by producer and consumer.  Loads and stores of it must be single
+ * instructions on the target: use uint8_t on 8-bit parts (ring size up to 128 bytes) and
+ * leave the default on 16/32-bit parts. */
+#ifndef MCTP_RING_IDX_T
+#define MCTP_RING_IDX_T uint16_t
+#endif
+
+/* Use C11 <stdatomic.h> for the index handoff when the compiler provides it; otherwise
+ * fall back to volatile indices with compiler barriers, which is sufficient on single-core
+ * microcontrollers where the producer is an interrupt handler. */
+#ifndef MCTP_RING_USE_C11_ATOMICS
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define MCTP_RING_USE_C11_ATOMICS 1
+#else
+#define MCTP_RING_USE_C11_ATOMICS 0
+#endif
+#endif
+
+#if MCTP_RING_USE_C11_ATOMICS
+#include <stdatomic.h>
+typedef _Atomic MCTP_RING_IDX_T mctp_ring_idx_t;
+typedef _Atomic uint32_t mctp_ring_counter_t;
+#else
+typedef volatile MCTP_RING_IDX_T mctp_ring_idx_t;
+typedef volatile uint32_t mctp_ring_counter_t;
+#endif
+
+typedef struct {
+    uint8_t* buf;                  /* storage, `size` bytes */
+    MCTP_RING_IDX_T mask;          /* size - 1 */
+    mctp_ring_idx_t head;          /* next write position (producer only) */
+    mctp_ring_idx_t tail;          /* next read position (consumer only) */
+    mctp_ring_counter_t overflows; /* bytes dropped because the ring was full */
+} mctp_ring_t;
+
+int mctp_ring_init(mctp_ring_t* r, uint8_t* storage, uint16_t size);
+
+/* producer side (interrupt handler / DMA callback) */
+uint8_t mctp_ring_put(mctp_ring_t* r, uint8_t b);
+uint16_t mctp_ring_write(mctp_ring_t* r, const uint8_t* data, uint16_t len);
+
+/* consumer side (main loop) */
+uint16_t mctp_ring_read(mctp_ring_t* r, uint8_t* buf, uint16_t max);
+uint16_t mctp_ring_count(mctp_ring_t* r);
+uint32_t mctp_ring_overflows(mctp_ring_t* r);
+
+#endif /* MCTP_RING_H */
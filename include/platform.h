@@ -54,6 +54,19 @@ uint8_t platform_serial_has_data(void);
  */
 uint8_t platform_serial_read_byte(void);
 
+/**
+ * @brief Read up to `max` bytes from the serial interface without blocking.
+ *
+ * Optional: the MCTP core provides a weak default built on
+ * platform_serial_has_data() and platform_serial_read_byte().  Platforms with
+ * a receive FIFO or DMA buffer may override it to hand over many bytes per call.
+ *
+ * @param buf Destination for the received bytes.
+ * @param max Maximum number of bytes to copy into `buf`.
+ * @return uint16_t Number of bytes copied into `buf` (0 when no data is available).
+ */
+uint16_t platform_serial_read(uint8_t* buf, uint16_t max);
+
 /**
  * @brief Write a byte to the serial interface. May block if the interface is not ready.
  *
@@ -61,6 +74,19 @@ uint8_t platform_serial_read_byte(void);
  */
 void platform_serial_write_byte(uint8_t b);
 
+/**
+ * @brief Write up to `len` bytes to the serial interface without blocking.
+ *
+ * Optional: the MCTP core provides a weak default built on
+ * platform_serial_can_write() and platform_serial_write_byte().  Platforms
+ * with a transmit FIFO or DMA may override it to accept many bytes per call.
+ *
+ * @param buf Bytes to transmit.
+ * @param len Number of bytes in `buf`.
+ * @return uint16_t Number of bytes accepted (0 when the interface is busy).
+ */
+uint16_t platform_serial_write(const uint8_t* buf, uint16_t len);
+
 /**
  * @brief Query whether the serial interface can accept writes.
  *
@@ -68,4 +94,15 @@ void platform_serial_write_byte(uint8_t b);
  */
 uint8_t platform_serial_can_write(void);
 
+/**
+ * @brief Milliseconds elapsed since an arbitrary starting point.
+ *
+ * Optional: used only to time out message reassembly.  The MCTP core provides
+ * a weak default that always returns 0, in which case stalled messages are
+ * only reclaimed when a new message needs their space.
+ *
+ * @return uint32_t Current time in milliseconds (wraps around).
+ */
+uint32_t platform_millis(void);
+
 #endif /* PLATFORM_H */
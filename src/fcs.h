@@ -32,7 +32,43 @@
 
 #include <stdint.h>
 
+/* Compile-time selection of the calc_fcs() implementation.  All variants produce identical
+ * results; they differ only in lookup-table size and speed:
+ *
+ *   MCTP_FCS_IMPL_TABLE   - byte-at-a-time lookup in a 256-entry table (default).
+ *   MCTP_FCS_IMPL_SLICE4  - slice-by-4, four 256-entry tables.
+ *   MCTP_FCS_IMPL_SLICE8  - slice-by-8, eight 256-entry tables.
+ *   MCTP_FCS_IMPL_NIBBLE  - two lookups per byte in a 16-entry table.
+ *   MCTP_FCS_IMPL_BITWISE - no table, eight shift/xor steps per byte.
+ *
+ *   mode      table    x86-64 -O2 ROM   x86-64 cycles/byte   8-bit AVR cycles/byte (approx.)
+ *   table     512 B        611 B               ~4.5                    ~15
+ *   slice4    2 KiB       2292 B               ~1.5                     -
+ *   slice8    4 KiB       4412 B               ~1.2                     -
+ *   nibble     32 B        147 B               ~10                     ~35
+ *   bitwise     0 B        116 B               ~24                     ~80
+ *
+ * ROM is text + data of src/fcs.c and cycles/byte is for a 70-byte frame, both as reported by
+ * `make bench`; the AVR column is estimated from the instruction count of the inner loop.  Sliced
+ * variants are intended for hosts that validate many frames; nibble and bitwise for parts where
+ * flash is scarcer than cycles.  Re-run the benchmark (or `size`) with the target toolchain when
+ * the trade-off matters.
+ */
+#define MCTP_FCS_IMPL_TABLE 0
+#define MCTP_FCS_IMPL_SLICE4 1
+#define MCTP_FCS_IMPL_SLICE8 2
+#define MCTP_FCS_IMPL_NIBBLE 3
+#define MCTP_FCS_IMPL_BITWISE 4
+
+#ifndef MCTP_FCS_IMPL
+#define MCTP_FCS_IMPL MCTP_FCS_IMPL_TABLE
+#endif
+
 uint16_t calc_fcs(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_byte(uint16_t f, uint8_t b);
+
+/* Host-side carry-less-multiply kernel with runtime dispatch (src/fcs_clmul.c) */
+uint16_t calc_fcs_clmul(uint16_t f, uint8_t* cp, int len);
 
 #define INITFCS 0xffff
 
@@ -0,0 +1,270 @@
+/**
+ * @file fcs_clmul.c
+ * @brief Carry-less-multiply FCS kernel for host builds.
+ *
+ * Provides `calc_fcs_clmul()`, a drop-in replacement for `calc_fcs()` that
+ * folds 16-byte blocks with PCLMULQDQ (x86-64) or PMULL (AArch64).  The CPU
+ * is probed once at run time; when neither instruction is available, or when
+ * the buffer is too short to amortize the setup, the call falls back to the
+ * table-driven `calc_fcs()`.
+ *
+ * The FCS is a bit-reflected CRC-16 with P(x) = x^16 + x^12 + x^5 + 1.  With
+ * the running FCS xored into the first two message bytes the result only
+ * depends on the message polynomial modulo P, so each 128-bit block can be
+ * multiplied forward by x^128 (or x^512 when four lanes are folded in
+ * parallel) and xored into the block that follows it.  The last folded block
+ * is congruent to the whole prefix and has the same length, so its FCS,
+ * computed with the byte table, is the FCS of the prefix.  The remaining tail
+ * bytes are then processed with the table as usual.  Because operands are
+ * bit-reflected, the folding constants are x^(D+63) and x^(D-1) mod P placed
+ * in the top 16 bits of a 64-bit lane for a fold distance of D bits.
+ *
+ * This file is intended for Linux-hosted harnesses and aggregators; embedded
+ * endpoints should continue to use `calc_fcs()` directly.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#include <stdint.h>
+
+#include "fcs.h"
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define FCS_CLMUL_ATOMICS 1
+#include <stdatomic.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FCS_CLMUL_X86 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define FCS_CLMUL_ARM 1
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#endif
+#endif
+
+/* fold constants: x^(D+63) mod P and x^(D-1) mod P, bit-reflected into the top of a 64-bit lane */
+#define FCS_K_128_HI 0xa95d000000000000ull /* x^191 */
+#define FCS_K_128_LO 0x7eea000000000000ull /* x^127 */
+#define FCS_K_512_HI 0x9822000000000000ull /* x^575 */
+#define FCS_K_512_LO 0x7f90000000000000ull /* x^511 */
+
+/* below this length the table loop is faster than setting up the fold */
+#define FCS_CLMUL_MIN_LEN 32
+
+typedef uint16_t (*fcs_kernel_t)(uint16_t fcs, uint8_t* cp, int len);
+
+/**
+ * @brief Finish a folded computation with the byte table.
+ *
+ * @param folded The 16-byte folded remainder (congruent to the processed prefix).
+ * @param tail Pointer to the bytes following the folded prefix.
+ * @param tail_len Number of tail bytes.
+ * @return uint16_t The FCS of the complete buffer.
+ */
+static uint16_t fcs_finish(uint8_t* folded, uint8_t* tail, int tail_len) {
+    uint16_t fcs = calc_fcs(0, folded, 16);
+    return calc_fcs(fcs, tail, tail_len);
+}
+
+#if FCS_CLMUL_X86
+/**
+ * @brief Fold a 128-bit block forward using PCLMULQDQ.
+ *
+ * @param x The block to fold.
+ * @param k Fold constants (low lane for the low qword, high lane for the high qword).
+ * @return __m128i The folded block, ready to be xored into the next block.
+ */
+__attribute__((target("pclmul,sse2"))) static inline __m128i fcs_fold_x86(__m128i x, __m128i k) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+/**
+ * @brief PCLMULQDQ FCS kernel.
+ *
+ * @param fcs Initial FCS value.
+ * @param cp Pointer to the data buffer.
+ * @param len Number of bytes to process; must be at least FCS_CLMUL_MIN_LEN.
+ * @return uint16_t Updated FCS value.
+ */
+__attribute__((target("pclmul,sse2"))) static uint16_t fcs_kernel_x86(uint16_t fcs, uint8_t* cp,
+                                                                     int len) {
+    const __m128i k128 = _mm_set_epi64x((long long)FCS_K_128_LO, (long long)FCS_K_128_HI);
+    int i;
+    __m128i acc;
+
+    if (len >= 64) {
+        const __m128i k512 = _mm_set_epi64x((long long)FCS_K_512_LO, (long long)FCS_K_512_HI);
+        __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cp), _mm_cvtsi32_si128(fcs));
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(cp + 16));
+        __m128i x2 = _mm_loadu_si128((const __m128i*)(cp + 32));
+        __m128i x3 = _mm_loadu_si128((const __m128i*)(cp + 48));
+        for (i = 64; i + 64 <= len; i += 64) {
+            x0 = _mm_xor_si128(fcs_fold_x86(x0, k512), _mm_loadu_si128((const __m128i*)(cp + i)));
+            x1 = _mm_xor_si128(fcs_fold_x86(x1, k512),
+                               _mm_loadu_si128((const __m128i*)(cp + i + 16)));
+            x2 = _mm_xor_si128(fcs_fold_x86(x2, k512),
+                               _mm_loadu_si128((const __m128i*)(cp + i + 32)));
+            x3 = _mm_xor_si128(fcs_fold_x86(x3, k512),
+                               _mm_loadu_si128((const __m128i*)(cp + i + 48)));
+        }
+        acc = _mm_xor_si128(fcs_fold_x86(x0, k128), x1);
+        acc = _mm_xor_si128(fcs_fold_x86(acc, k128), x2);
+        acc = _mm_xor_si128(fcs_fold_x86(acc, k128), x3);
+    } else {
+        acc = _mm_xor_si128(_mm_loadu_si128((const __m128i*)cp), _mm_cvtsi32_si128(fcs));
+        i = 16;
+    }
+    for (; i + 16 <= len; i += 16) {
+        acc = _mm_xor_si128(fcs_fold_x86(acc, k128), _mm_loadu_si128((const __m128i*)(cp + i)));
+    }
+
+    uint8_t folded[16];
+    _mm_storeu_si128((__m128i*)folded, acc);
+    return fcs_finish(folded, cp + i, len - i);
+}
+#endif /* FCS_CLMUL_X86 */
+
+#if FCS_CLMUL_ARM
+#if defined(__clang__)
+#define FCS_TARGET_PMULL __attribute__((target("aes")))
+#else
+#define FCS_TARGET_PMULL __attribute__((target("+crypto")))
+#endif
+
+/**
+ * @brief Fold a 128-bit block forward using PMULL.
+ *
+ * @param x The block to fold.
+ * @param k Fold constants (lane 0 for the low doubleword, lane 1 for the high doubleword).
+ * @return uint8x16_t The folded block, ready to be xored into the next block.
+ */
+FCS_TARGET_PMULL static inline uint8x16_t fcs_fold_arm(uint8x16_t x, poly64x2_t k) {
+    poly64x2_t xp = vreinterpretq_p64_u8(x);
+    poly128_t lo = vmull_p64(vgetq_lane_p64(xp, 0), vgetq_lane_p64(k, 0));
+    poly128_t hi = vmull_high_p64(xp, k);
+    return veorq_u8(vreinterpretq_u8_p128(lo), vreinterpretq_u8_p128(hi));
+}
+
+/**
+ * @brief PMULL FCS kernel.
+ *
+ * @param fcs Initial FCS value.
+ * @param cp Pointer to the data buffer.
+ * @param len Number of bytes to process; must be at least FCS_CLMUL_MIN_LEN.
+ * @return uint16_t Updated FCS value.
+ */
+FCS_TARGET_PMULL static uint16_t fcs_kernel_arm(uint16_t fcs, uint8_t* cp, int len) {
+    const poly64x2_t k128 =
+        vreinterpretq_p64_u64(vcombine_u64(vcreate_u64(FCS_K_128_HI), vcreate_u64(FCS_K_128_LO)));
+    const uint8x16_t init =
+        vreinterpretq_u8_u64(vcombine_u64(vcreate_u64((uint64_t)fcs), vcreate_u64(0)));
+    int i;
+    uint8x16_t acc;
+
+    if (len >= 64) {
+        const poly64x2_t k512 = vreinterpretq_p64_u64(
+            vcombine_u64(vcreate_u64(FCS_K_512_HI), vcreate_u64(FCS_K_512_LO)));
+        uint8x16_t x0 = veorq_u8(vld1q_u8(cp), init);
+        uint8x16_t x1 = vld1q_u8(cp + 16);
+        uint8x16_t x2 = vld1q_u8(cp + 32);
+        uint8x16_t x3 = vld1q_u8(cp + 48);
+        for (i = 64; i + 64 <= len; i += 64) {
+            x0 = veorq_u8(fcs_fold_arm(x0, k512), vld1q_u8(cp + i));
+            x1 = veorq_u8(fcs_fold_arm(x1, k512), vld1q_u8(cp + i + 16));
+            x2 = veorq_u8(fcs_fold_arm(x2, k512), vld1q_u8(cp + i + 32));
+            x3 = veorq_u8(fcs_fold_arm(x3, k512), vld1q_u8(cp + i + 48));
+        }
+        acc = veorq_u8(fcs_fold_arm(x0, k128), x1);
+        acc = veorq_u8(fcs_fold_arm(acc, k128), x2);
+        acc = veorq_u8(fcs_fold_arm(acc, k128), x3);
+    } else {
+        acc = veorq_u8(vld1q_u8(cp), init);
+        i = 16;
+    }
+    for (; i + 16 <= len; i += 16) {
+        acc = veorq_u8(fcs_fold_arm(acc, k128), vld1q_u8(cp + i));
+    }
+
+    uint8_t folded[16];
+    vst1q_u8(folded, acc);
+    return fcs_finish(folded, cp + i, len - i);
+}
+#endif /* FCS_CLMUL_ARM */
+
+/**
+ * @brief Select the FCS kernel supported by the running CPU.
+ *
+ * @return fcs_kernel_t The carry-less-multiply kernel, or `calc_fcs` when the
+ *         CPU lacks the required instructions.
+ */
+static fcs_kernel_t fcs_select_kernel(void) {
+#if FCS_CLMUL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2")) return fcs_kernel_x86;
+#elif FCS_CLMUL_ARM
+#if defined(__APPLE__)
+    return fcs_kernel_arm;
+#elif defined(__linux__)
+    if (getauxval(AT_HWCAP) & HWCAP_PMULL) return fcs_kernel_arm;
+#endif
+#endif
+    return calc_fcs;
+}
+
+/* Resolved on first use.  Concurrent first calls may each run the selection,
+ * which always yields the same kernel, so relaxed atomic accesses suffice. */
+#if FCS_CLMUL_ATOMICS
+static _Atomic(fcs_kernel_t) fcs_kernel = 0;
+#define FCS_KERNEL_LOAD() atomic_load_explicit(&fcs_kernel, memory_order_relaxed)
+#define FCS_KERNEL_STORE(k) atomic_store_explicit(&fcs_kernel, (k), memory_order_relaxed)
+#else
+static fcs_kernel_t fcs_kernel = 0;
+#define FCS_KERNEL_LOAD() fcs_kernel
+#define FCS_KERNEL_STORE(k) (fcs_kernel = (k))
+#endif
+
+/**
+ * @brief Compute the 16-bit FCS using carry-less multiply where available.
+ *
+ * Produces exactly the same result as `calc_fcs()` for every input.  Buffers
+ * shorter than 32 bytes, and all buffers on CPUs without PCLMULQDQ/PMULL, are
+ * handed to `calc_fcs()`.
+ *
+ * @param fcs Initial FCS value (use `INITFCS` to start a new calculation).
+ * @param cp Pointer to the data buffer to include in the FCS calculation.
+ * @param len Number of bytes to process from `cp`.
+ * @return uint16_t Updated FCS value.
+ */
+uint16_t calc_fcs_clmul(uint16_t fcs, uint8_t* cp, int len) {
+    if (len < FCS_CLMUL_MIN_LEN) return calc_fcs(fcs, cp, len);
+    fcs_kernel_t kernel = FCS_KERNEL_LOAD();
+    if (!kernel) {
+        kernel = fcs_select_kernel();
+        FCS_KERNEL_STORE(kernel);
+    }
+    return kernel(fcs, cp, len);
+}
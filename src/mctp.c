@@ -9,7 +9,7 @@
  * Endpoint Operational constraints and assumptions:
  *   - The endpoint is single-threaded.  It only processes one packet at a time.
  *       - if a new packet is received while processing a previous packet, the new packet will be
- *         silently discarded.
+ *         silently discarded, unless MCTP_RX_QUEUE_DEPTH provides a receive queue.
  *       - this allows us to reduce overall buffer requirements.
  *   - The endpoint responds to requests only - it does not initiate any requests on its own.
  *     Although it may send datagram messages triggered by events.
@@ -18,7 +18,9 @@
  *       - get endpoint id
  *       - get version support
  *       - get message type support
- *   - The endpoint connects to one bus only
+ *   - Each endpoint (`mctp_endpoint_t`) connects to one bus only; a program
+ *     may run any number of endpoints, each with its own platform ops.  An
+ *     endpoint must only be used from one thread at a time.
  *   - The endpoint does not support the "discovered" flag for endpoint IDs.
  *
  * @author Douglas Sandy
@@ -45,20 +47,28 @@
 #include "mctp.h"
 
 #include <stdint.h>
+#include <string.h>
 
-#include "platform.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #ifdef PLDM_SUPPORT
 #include "pldm_version.h"
 #endif
 
 /* forward declarations for private functions */
-uint8_t mctp_send_frame(void);
+static uint16_t mctp_tx_pump(mctp_endpoint_t* ep);
 uint16_t calc_fcs(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_byte(uint16_t f, uint8_t b);
 
-/* transmission unit and buffer size management */
-#define BASELINE_TRANSMISSION_UNIT 64
-#define MCTP_BUFFER_SIZE (BASELINE_TRANSMISSION_UNIT + 6)  // add space for framing bytes and header
+/* transmission unit and buffer size management (MCTP_BUFFER_SIZE is set in mctp.h) */
+#if (MCTP_TRANSMISSION_UNIT < BASELINE_TRANSMISSION_UNIT) || (MCTP_TRANSMISSION_UNIT > 255)
+#error "MCTP_TRANSMISSION_UNIT must be between 64 and 255"
+#endif
 
 /* framer state definitions (single source of truth) */
 #include "mctp_framer_states.h"
@@ -75,46 +85,92 @@ uint16_t calc_fcs(uint16_t f, uint8_t* cp, int len);
 #define OFFSET_CTRL_COMMAND_CODE 9
 #define OFFSET_CTRL_COMPLETION_CODE 10
 
+/* smallest byte count of a packet: the transport header (version, EIDs and flags) */
+#define MIN_BYTE_COUNT (OFFSET_MSG_TYPE - OFFSET_MCTP_HEADER_VERSION)
+
+/* weak linkage for the control dispatch table, which applications may replace */
+#if defined(__GNUC__)
+#define MCTP_WEAK __attribute__((weak))
+#else
+#define MCTP_WEAK
+#endif
+
 /* framing characters */
 #define FRAME_CHAR 0x7E
 #define ESCAPE_CHAR 0x7D
 
-/* device configuration */
-static uint8_t endpoint_id = 0x00;             // set to unprogrammed
-static uint8_t byte_count;                     // body bytes left to receive for current frame
-#ifdef UNIT_TEST
-uint8_t buffer_idx;                     /* index into the receive buffer (exposed to tests) */
-uint8_t rxState;                        /* current framer state (exposed to tests) */
-uint8_t mctp_buffer[MCTP_BUFFER_SIZE];  /* transmission/reception buffer (exposed to tests) */
+/* Endpoint state lives in `mctp_endpoint_t` (see mctp.h); every function
+   below works on the endpoint passed as `ep`. */
+
+/* Pre-escaped image of the primary response (worst case every body/FCS byte doubles) */
+#if MCTP_TX_STAGING_ENABLED
+#define MCTP_TX_STAGING_SIZE (2 * MCTP_BUFFER_SIZE)
+#endif
+
+/* Optional prioritized event TX queue: descriptors in a ring, frames packed in a byte arena */
+#if MCTP_EVENT_TX_ENABLED
+#if MCTP_EVENT_ARENA_SIZE < MCTP_EVENT_TX_BUF_SIZE
+#error "MCTP_EVENT_ARENA_SIZE must hold at least one MCTP_EVENT_TX_BUF_SIZE event"
+#endif
+#if (MCTP_EVENT_QUEUE_DEPTH < 1) || (MCTP_EVENT_QUEUE_DEPTH > 255)
+#error "MCTP_EVENT_QUEUE_DEPTH must be between 1 and 255"
+#endif
+#define TX_EVENT_PENDING(ep) ((ep)->event_count != 0)
+#if (MCTP_TX_SCHED != MCTP_TX_SCHED_STRICT) && (MCTP_TX_SCHED != MCTP_TX_SCHED_ROUND_ROBIN) && \
+    (MCTP_TX_SCHED != MCTP_TX_SCHED_DEADLINE)
+#error "MCTP_TX_SCHED must be MCTP_TX_SCHED_STRICT, _ROUND_ROBIN or _DEADLINE"
+#endif
 #else
-static uint8_t buffer_idx;                     // index into the receive buffer
-static uint8_t rxState;                        // current framer state
-static uint8_t mctp_buffer[MCTP_BUFFER_SIZE];  // transmission/reception buffer
+#define TX_EVENT_PENDING(ep) 0
 #endif
 
-/* send state for reentrant transmit */
-static uint16_t send_total_len = 0;
-static uint16_t send_idx = 0;
-static uint8_t send_in_progress = 0;
-static uint8_t send_escape_pending = 0;
-static uint8_t send_pending_byte = 0;
+/* Optional sender of messages longer than one packet */
+#if MCTP_FRAGMENTATION_ENABLED
+#define TX_MESSAGE_PENDING(ep) ((ep)->tx_msg.active != 0)
+#else
+#define TX_MESSAGE_PENDING(ep) 0
+#endif
 
-/* Optional single prioritized event TX slot */
-#if MCTP_EVENT_TX_ENABLED
-static uint8_t tx_buf_event[MCTP_EVENT_TX_BUF_SIZE];
-static uint16_t tx_event_len = 0;
-static uint16_t tx_event_idx = 0;
-static uint8_t tx_event_pending = 0;
-static uint8_t tx_event_escape_pending = 0;
-static uint8_t tx_event_pending_byte = 0;
+#if MCTP_FULL_DUPLEX_ENABLED
+/* the response is moved out of the packet buffer so the next request can be received meanwhile */
+#define TX_RESPONSE_READY(ep) ((ep)->tx_response_pending != 0)
+#define TX_RESPONSE_FRAME(ep) ((ep)->tx_response)
+#else
+#define TX_RESPONSE_READY(ep) ((ep)->rx_state == SENDING_RESPONSE)
+#define TX_RESPONSE_FRAME(ep) ((ep)->buffer)
 #endif
 
-/* current active tx slot: 0 = none, 1 = primary (mctp_buffer), 2 = event */
-static uint8_t current_tx_slot = 0;
+#if MCTP_RX_QUEUE_DEPTH
+#if MCTP_RX_QUEUE_DEPTH > 254
+#error "MCTP_RX_QUEUE_DEPTH must be at most 254"
+#endif
+/* Frames are assembled in the slot at rx_queue_tail; completed frames wait in
+   the slots before it until mctp_update() copies them into the packet buffer.
+   One slot more than the queue depth keeps a free slot for assembly at all times. */
+#define RX_QUEUE_SLOTS (MCTP_RX_QUEUE_DEPTH + 1)
+#define RX_STATE(ep) ((ep)->rx_framer_state)
+#define RX_BUF(ep) ((ep)->rx_slots[(ep)->rx_queue_tail])
+#define RX_IDX(ep) ((ep)->rx_framer_idx)
+#else
+/* the receive state machine assembles frames directly in the packet buffer */
+#define RX_STATE(ep) ((ep)->rx_state)
+#define RX_BUF(ep) ((ep)->buffer)
+#define RX_IDX(ep) ((ep)->buffer_idx)
+#endif
 
 /* FCS calculation moved to src/fcs.c for testability */
 #include "fcs.h"
 
+/* control command dispatch table; applications replace it to add commands (see mctp.h) */
+#if (MCTP_CONTROL_COMMANDS <= CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT) || (MCTP_CONTROL_COMMANDS > 256)
+#error "MCTP_CONTROL_COMMANDS must be between 6 and 256"
+#endif
+#if OFFSET_CTRL_COMPLETION_CODE + 2 + MCTP_CONTROL_COMMANDS + 3 > MCTP_BUFFER_SIZE
+#error "MCTP_CONTROL_COMMANDS too large for the Get Message Type Support response"
+#endif
+MCTP_WEAK const mctp_control_handler_t mctp_control_handlers[MCTP_CONTROL_COMMANDS] = {
+    MCTP_CONTROL_STANDARD_HANDLERS};
+
 /**********************************************************************************
  * static functions.  These are only visible within this file.
  **********************************************************************************/
@@ -134,30 +190,200 @@ static uint8_t current_tx_slot = 0;
  *
  * This checks that the received buffer contains a minimally-sized
  * frame, that the length field matches the received size, and that
- * the calculated FCS matches the frame FCS.
+ * the FCS accumulated while receiving matches the frame FCS.  The FCS
+ * is folded in byte by byte by mctp_update(), so validation takes
+ * constant time regardless of the frame length.
  *
+ * @param ep Endpoint.
  * @return uint8_t Returns 1 if the received frame is valid, 0 otherwise.
  */
-static uint8_t validate_rx() {
+static uint8_t validate_rx(mctp_endpoint_t* ep) {
     // minimum valid frame is 11 bytes:
-    if (buffer_idx < 11) return 0;
+    if (RX_IDX(ep) < 11) return 0;
 
     // get the byte count from the length field
-    byte_count = mctp_buffer[2];
+    ep->byte_count = RX_BUF(ep)[2];
 
     // verify the byte count matches the received length
-    if ((uint16_t)byte_count != (uint16_t)buffer_idx - 6) return 0;
-
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, buffer_idx - 4);
+    if ((uint16_t)ep->byte_count != (uint16_t)RX_IDX(ep) - 6) return 0;
 
     // get the expected FCS from the message
-    uint16_t msg_fcs = mctp_buffer[buffer_idx - 3];
+    uint16_t msg_fcs = RX_BUF(ep)[RX_IDX(ep) - 3];
     msg_fcs = msg_fcs << 8;
-    msg_fcs += mctp_buffer[buffer_idx - 2];
+    msg_fcs += RX_BUF(ep)[RX_IDX(ep) - 2];
 
     // return the result of the comparison
-    return msg_fcs == fcs;
+    return msg_fcs == ep->rx_fcs;
+}
+
+/* Constant control response bodies, from the completion code on */
+static const uint8_t version_body[] = {
+    CONTROL_COMPLETE_SUCCESS, 1,  // version entry count
+    0x01, 0x03, 0x01, 0x00        // current version of the specification (1.3.1)
+};
+static const uint8_t version_unsupported_body[] = {
+    0x80, 0x00  // message type number not supported, version number entry count = 0
+};
+
+/* A constant control response.  With MCTP_RESPONSE_TEMPLATES_ENABLED each
+   endpoint holds its own templates (struct mctp_response_template, built by
+   mctp_init()) with the FCS contribution of the command code and body cached,
+   so only the header bytes up to the instance id are folded in per response:
+   the FCS register after those bytes is carried across the cached bytes with
+   a precomputed 16 x 16 bit matrix (the FCS is linear in the register), one
+   column per register bit.  Without templates the constant bodies are sent
+   from shared read-only descriptors. */
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+#define VERSION_TEMPLATE(ep) (&(ep)->version_template)
+#define VERSION_UNSUPPORTED_TEMPLATE(ep) (&(ep)->version_unsupported_template)
+#define MESSAGE_TYPES_TEMPLATE(ep) (&(ep)->message_types_template)
+#else
+struct mctp_response_template {
+    const uint8_t* body;  // response bytes from the completion code on
+    uint8_t len;          // number of body bytes
+};
+static const struct mctp_response_template version_template = {
+    .body = version_body, .len = sizeof(version_body)};
+static const struct mctp_response_template version_unsupported_template = {
+    .body = version_unsupported_body, .len = sizeof(version_unsupported_body)};
+#define VERSION_TEMPLATE(ep) (&version_template)
+#define VERSION_UNSUPPORTED_TEMPLATE(ep) (&version_unsupported_template)
+#endif
+
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+/**
+ * @brief Precompute the cached FCS contribution of a response template.
+ *
+ * @param t Template to fill in.
+ * @param command Control command code the template answers.
+ * @param body Response bytes from the completion code on.
+ * @param len Number of body bytes.
+ */
+static void response_template_init(struct mctp_response_template* t, uint8_t command,
+                                   const uint8_t* body, uint8_t len) {
+    t->body = body;
+    t->len = len;
+    t->partial = calc_fcs(calc_fcs_byte(0, command), (uint8_t*)body, len);
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        uint16_t f = (uint16_t)(1u << bit);
+        for (uint8_t i = 0; i <= len; i++) {
+            f = calc_fcs_byte(f, 0);
+        }
+        t->shift[bit] = f;
+    }
+}
+
+/**
+ * @brief Build an endpoint's response templates; the message type list comes from
+ * `mctp_control_handlers`.
+ *
+ * @param ep Endpoint.
+ */
+static void response_templates_init(mctp_endpoint_t* ep) {
+    uint8_t n = 0;
+    for (uint16_t command = 0; command < MCTP_CONTROL_COMMANDS; command++) {
+        if (mctp_control_handlers[command] != NULL) {
+            ep->message_types_body[2 + n++] = (uint8_t)command;
+        }
+    }
+    ep->message_types_body[0] = CONTROL_COMPLETE_SUCCESS;
+    ep->message_types_body[1] = n;
+    response_template_init(&ep->version_template, CONTROL_MSG_GET_MCTP_VERSION_SUPPORT,
+                           version_body, sizeof(version_body));
+    response_template_init(&ep->version_unsupported_template,
+                           CONTROL_MSG_GET_MCTP_VERSION_SUPPORT, version_unsupported_body,
+                           sizeof(version_unsupported_body));
+    response_template_init(&ep->message_types_template, CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT,
+                           ep->message_types_body, (uint8_t)(n + 2));
+}
+
+/**
+ * @brief FCS of a templated response, given the register after its header.
+ *
+ * @param t Response template.
+ * @param fcs FCS register after the bytes preceding the command code.
+ * @return uint16_t FCS of the whole frame.
+ */
+static uint16_t response_template_fcs(const struct mctp_response_template* t, uint16_t fcs) {
+    uint16_t result = t->partial;
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        if (fcs & (1u << bit)) {
+            result ^= t->shift[bit];
+        }
+    }
+    return result;
+}
+#endif
+
+/**
+ * @brief Finish the response built over the request in the packet buffer and send it.
+ *
+ * The single response path shared by the control handlers and, through
+ * mctp_send_response(), by PLDM and vendor handlers.  The request's transport
+ * header becomes the response header: source and destination EIDs are
+ * swapped, the Tag Owner (TO) bit is toggled and SOM/EOM are set for a single
+ * packet response.  The byte count, FCS and frame end character follow the
+ * message, and the frame is handed to mctp_send_frame().
+ *
+ * @param ep Endpoint.
+ * @param end Index in the packet buffer following the last message byte.
+ * @param t Template the control response was copied from, or NULL.
+ */
+static void finalize_response(mctp_endpoint_t* ep, uint16_t end,
+                              const struct mctp_response_template* t) {
+    // reverse the source and destination EID values
+    uint8_t source_eid = ep->buffer[OFFSET_SOURCE_ENDPOINT_ID];
+    ep->buffer[OFFSET_SOURCE_ENDPOINT_ID] = ep->buffer[OFFSET_DESTINATION_ENDPOINT_ID];
+    ep->buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
+
+    // toggle the TO bit and set the som/eom bits to indicate a single frame response
+    ep->buffer[OFFSET_FLAGS] = (uint8_t)((ep->buffer[OFFSET_FLAGS] ^ 0x08) | 0xC0);
+
+    // byte count, FCS and frame end character
+    ep->buffer[OFFSET_BYTE_COUNT] = (uint8_t)(end - OFFSET_BYTE_COUNT - 1);
+    uint16_t fcs;
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+    if (t != NULL) {
+        fcs = calc_fcs(INITFCS, ep->buffer + 1, OFFSET_CTRL_COMMAND_CODE - 1);
+        fcs = response_template_fcs(t, fcs);
+    } else
+#else
+    (void)t;
+#endif
+    {
+        fcs = calc_fcs(INITFCS, ep->buffer + 1, end - 1);
+    }
+    ep->buffer[end++] = (uint8_t)(fcs >> 8);
+    ep->buffer[end++] = (uint8_t)(fcs & 0x00FF);
+    ep->buffer[end] = FRAME_CHAR;
+
+    mctp_send_frame_ctx(ep);
+}
+
+/**
+ * @brief Finish and send a control response whose body ends at `end`.
+ *
+ * Clears the Rq bit in the instance id byte, then finalizes the response.
+ *
+ * @param ep Endpoint.
+ * @param end Index in the packet buffer following the last response byte.
+ */
+static void send_control_response(mctp_endpoint_t* ep, uint16_t end) {
+    ep->buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
+    finalize_response(ep, end, NULL);
+}
+
+/**
+ * @brief Send a constant control response.
+ *
+ * @param ep Endpoint.
+ * @param t Template holding the response body.
+ */
+static void send_control_template(mctp_endpoint_t* ep,
+                                  const struct mctp_response_template* t) {
+    memcpy(&ep->buffer[OFFSET_CTRL_COMPLETION_CODE], t->body, t->len);
+    ep->buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
+    finalize_response(ep, (uint16_t)(OFFSET_CTRL_COMPLETION_CODE + t->len), t);
 }
 
 /**
@@ -167,15 +393,16 @@ static uint8_t validate_rx() {
  * produces an appropriate response which is transmitted using
  * @c mctp_send_frame().
  *
+ * @param ep Endpoint.
  */
-static void process_set_endpoint_id_control_message() {
+void process_set_endpoint_id_control_message(mctp_endpoint_t* ep) {
     // dont process packet if not ready
-    if (!mctp_is_packet_available()) return;
+    if (!mctp_is_packet_available_ctx(ep)) return;
 
     // get the requested endpoint id from the message payload
     uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
-    uint8_t operation = mctp_buffer[idx++] & 0x02;
-    uint8_t eid = mctp_buffer[idx++];
+    uint8_t operation = ep->buffer[idx++] & 0x02;
+    uint8_t eid = ep->buffer[idx++];
     uint8_t completion_code;
     uint8_t endpoint_acceptance_status = 0x10;  // EID rejected by default
     if (operation == 0x02) {
@@ -200,49 +427,15 @@ static void process_set_endpoint_id_control_message() {
 
     // message body for response
     idx = OFFSET_CTRL_COMPLETION_CODE;
-    mctp_buffer[idx++] = completion_code;
-    mctp_buffer[idx++] = endpoint_acceptance_status;
-    mctp_buffer[idx++] = endpoint_id;
-    mctp_buffer[idx++] = 0x00;  // eid pool size
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // toggle the Tag Owner (TO) bit for responses
-    mctp_buffer[OFFSET_FLAGS] ^= 0x08;
-
-    //===========
-    // set the som/eom bits to indicate single frame response
-    mctp_buffer[OFFSET_FLAGS] |= 0xC0;
-
-    //===========
-    // updates to the media independent header
-    // reverse the source and destination EID values
-    uint8_t source_eid = mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID];
-    uint8_t dest_eid = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-    mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID] = dest_eid;
-    mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
-
-    // recalculate the byte count
-    mctp_buffer[OFFSET_BYTE_COUNT] = idx - OFFSET_BYTE_COUNT - 1;
-
-    //==========
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, idx - 1);
-    mctp_buffer[idx++] = (fcs >> 8);
-    mctp_buffer[idx++] = (fcs & 0x00FF);
-
-    // add the frame end character
-    mctp_buffer[idx++] = FRAME_CHAR;
-
-    mctp_send_frame();
+    ep->buffer[idx++] = completion_code;
+    ep->buffer[idx++] = endpoint_acceptance_status;
+    ep->buffer[idx++] = ep->endpoint_id;
+    ep->buffer[idx++] = 0x00;  // eid pool size
+    send_control_response(ep, idx);
 
     // set the endpoint id
     if (completion_code == CONTROL_COMPLETE_SUCCESS) {
-        endpoint_id = eid;
+        ep->endpoint_id = eid;
     }
 }
 
@@ -252,55 +445,17 @@ static void process_set_endpoint_id_control_message() {
  * Fills the response payload with the current endpoint ID and
  * sends the response frame.
  *
+ * @param ep Endpoint.
  */
-void process_get_endpoint_id_control_message() {
+void process_get_endpoint_id_control_message(mctp_endpoint_t* ep) {
     // dont process packet if not ready
-    if (!mctp_is_packet_available()) return;
+    if (!mctp_is_packet_available_ctx(ep)) return;
 
     uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
-    mctp_buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
-    mctp_buffer[idx++] = endpoint_id;
-    mctp_buffer[idx++] = 0x00;  // endpoint type = simple endpoint;
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // updates to the media independent header
-    // reverse the source and destination EID values
-    uint8_t source_eid = mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID];
-    uint8_t dest_eid = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-    mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID] = dest_eid;
-    mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
-
-    // recalculate the byte count
-    mctp_buffer[OFFSET_BYTE_COUNT] = idx - OFFSET_BYTE_COUNT - 1;
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // toggle the Tag Owner (TO) bit for responses
-    mctp_buffer[OFFSET_FLAGS] ^= 0x08;
-
-    //===========
-    // set the som/eom bits to indicate single frame response
-    mctp_buffer[OFFSET_FLAGS] |= 0xC0;
-
-    //==========
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, idx - 1);
-    mctp_buffer[idx++] = (fcs >> 8);
-    mctp_buffer[idx++] = (fcs & 0x00FF);
-
-    // add the frame end character
-    mctp_buffer[idx++] = FRAME_CHAR;
-
-    mctp_send_frame();
+    ep->buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
+    ep->buffer[idx++] = ep->endpoint_id;
+    ep->buffer[idx++] = 0x00;  // endpoint type = simple endpoint;
+    send_control_response(ep, idx);
 }
 
 /**
@@ -309,141 +464,65 @@ void process_get_endpoint_id_control_message() {
  * Determines the supported version(s) for the requested message type
  * and constructs a response containing version entries.
  *
+ * @param ep Endpoint.
  */
-static void process_get_mctp_version_support_control_message() {
+void process_get_mctp_version_support_control_message(mctp_endpoint_t* ep) {
     // dont process packet if not ready
-    if (!mctp_is_packet_available()) return;
+    if (!mctp_is_packet_available_ctx(ep)) return;
 
     // get the message type from the message payload
-    uint8_t msg_type = mctp_buffer[OFFSET_CTRL_COMPLETION_CODE];
-    uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
-    if (msg_type == 0x00) {
-        // control protocol message version information
-        mctp_buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
-        mctp_buffer[idx++] = 1;  // version entry count
-        // current version of the specification (1.3.1)
-        mctp_buffer[idx++] = 0x01;  // major version
-        mctp_buffer[idx++] = 0x03;  // minor version
-        mctp_buffer[idx++] = 0x01;  // update version
-        mctp_buffer[idx++] = 0x00;  // alpha version
-    } else if (msg_type == 0xff) {
-        // base specification version information
-        mctp_buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
-        mctp_buffer[idx++] = 1;  // version entry count
-        // current version of the specification (1.3.1)
-        mctp_buffer[idx++] = 0x01;  // major version
-        mctp_buffer[idx++] = 0x03;  // minor version
-        mctp_buffer[idx++] = 0x01;  // update version
-        mctp_buffer[idx++] = 0x00;  // alpha version
+    uint8_t msg_type = ep->buffer[OFFSET_CTRL_COMPLETION_CODE];
+    if ((msg_type == 0x00) || (msg_type == 0xff)) {
+        // control protocol or base specification version information
+        send_control_template(ep, VERSION_TEMPLATE(ep));
     }
 #ifdef PLDM_SUPPORT
     else if (msg_type == 0x01) {
         // MCTP message type for pldm support
-        mctp_rx_buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
-        mctp_rx_buffer[idx++] = 1;  // version entry count
-        // current version of the specification (1.3.1)
-        mctp_rx_buffer[idx++] = pldm_major_version;   // major version
-        mctp_rx_buffer[idx++] = pldm_minor_version;   // minor version
-        mctp_rx_buffer[idx++] = pldm_update_version;  // update version
-        mctp_rx_buffer[idx++] = 0x00;                 // alpha version
+        uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
+        ep->buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
+        ep->buffer[idx++] = 1;  // version entry count
+        ep->buffer[idx++] = pldm_major_version;   // major version
+        ep->buffer[idx++] = pldm_minor_version;   // minor version
+        ep->buffer[idx++] = pldm_update_version;  // update version
+        ep->buffer[idx++] = 0x00;                 // alpha version
+        send_control_response(ep, idx);
     }
 #endif
     else {
         // unsupported message type
-        mctp_buffer[idx++] = 0x80;  // message type number not supported
-        mctp_buffer[idx++] = 0x00;  // version number entry count = 0;
+        send_control_template(ep, VERSION_UNSUPPORTED_TEMPLATE(ep));
     }
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // toggle the Tag Owner (TO) bit for responses
-    mctp_buffer[OFFSET_FLAGS] ^= 0x08;
-
-    //===========
-    // set the som/eom bits to indicate single frame response
-    mctp_buffer[OFFSET_FLAGS] |= 0xC0;
-
-    //===========
-    // updates to the media independent header
-    // reverse the source and destination EID values
-    uint8_t source_eid = mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID];
-    uint8_t dest_eid = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-    mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID] = dest_eid;
-    mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
-
-    // recalculate the byte count
-    mctp_buffer[OFFSET_BYTE_COUNT] = idx - OFFSET_BYTE_COUNT - 1;
-
-    //==========
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, idx - 1);
-    mctp_buffer[idx++] = (fcs >> 8);
-    mctp_buffer[idx++] = (fcs & 0x00FF);
-
-    // add the frame end character
-    mctp_buffer[idx++] = FRAME_CHAR;
-
-    mctp_send_frame();
 }
 
 /**
  * @brief Handle a Get Message Type Support control request.
  *
- * Responds with a list of MCTP message types supported by this
- * endpoint (control, PLDM if enabled, etc.).
+ * Responds with the list of control commands supported by this endpoint,
+ * generated from `mctp_control_handlers` in ascending command order (by
+ * mctp_init() for each endpoint, when response templates are enabled).
  *
+ * @param ep Endpoint.
  */
-void process_get_message_type_support_control_message() {
+void process_get_message_type_support_control_message(mctp_endpoint_t* ep) {
     // dont process packet if not ready
-    if (!mctp_is_packet_available()) return;
+    if (!mctp_is_packet_available_ctx(ep)) return;
 
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+    send_control_template(ep, MESSAGE_TYPES_TEMPLATE(ep));
+#else
     uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
     // control protocol message version information
-    mctp_buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
-    mctp_buffer[idx++] = 4;  // total message types supported
-    mctp_buffer[idx++] = CONTROL_MSG_SET_ENDPOINT_ID;
-    mctp_buffer[idx++] = CONTROL_MSG_GET_ENDPOINT_ID;
-    mctp_buffer[idx++] = CONTROL_MSG_GET_MCTP_VERSION_SUPPORT;
-    mctp_buffer[idx++] = CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT;
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // toggle the Tag Owner (TO) bit for responses
-    mctp_buffer[OFFSET_FLAGS] ^= 0x08;
-
-    //===========
-    // set the som/eom bits to indicate single frame response
-    mctp_buffer[OFFSET_FLAGS] |= 0xC0;
-
-    //===========
-    // updates to the media independent header
-    // reverse the source and destination EID values
-    uint8_t source_eid = mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID];
-    uint8_t dest_eid = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-    mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID] = dest_eid;
-    mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
-
-    // recalculate the byte count
-    mctp_buffer[OFFSET_BYTE_COUNT] = idx - OFFSET_BYTE_COUNT - 1;
-
-    //==========
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, idx - 1);
-    mctp_buffer[idx++] = (fcs >> 8);
-    mctp_buffer[idx++] = (fcs & 0x00FF);
-
-    // add the frame end character
-    mctp_buffer[idx++] = FRAME_CHAR;
-
-    mctp_send_frame();
+    ep->buffer[idx++] = CONTROL_COMPLETE_SUCCESS;
+    uint16_t count_idx = idx++;  // total message types supported, filled in below
+    for (uint16_t command = 0; command < MCTP_CONTROL_COMMANDS; command++) {
+        if (mctp_control_handlers[command] != NULL) {
+            ep->buffer[idx++] = (uint8_t)command;
+        }
+    }
+    ep->buffer[count_idx] = (uint8_t)(idx - count_idx - 1);
+    send_control_response(ep, idx);
+#endif
 }
 
 /**
@@ -451,194 +530,253 @@ void process_get_message_type_support_control_message() {
  *
  * Sends an unsupported command response back to the requester.
  *
+ * @param ep Endpoint.
  */
-static void process_unsupported_control_message() {
+static void process_unsupported_control_message(mctp_endpoint_t* ep) {
     // dont process packet if not ready
-    if (!mctp_is_packet_available()) return;
+    if (!mctp_is_packet_available_ctx(ep)) return;
 
     uint16_t idx = OFFSET_CTRL_COMPLETION_CODE;
-    mctp_buffer[idx++] = CONTROL_COMPLETE_UNSUPPORTED_CMD;
-
-    //===========
-    // updates to the control message header
-    // clear the rq bit in the instance id byte
-    mctp_buffer[OFFSET_CTRL_INSTANCE_ID] &= ~0x80;
-
-    //===========
-    // toggle the Tag Owner (TO) bit for responses
-    mctp_buffer[OFFSET_FLAGS] ^= 0x08;
-
-    //===========
-    // set the som/eom bits to indicate single frame response
-    mctp_buffer[OFFSET_FLAGS] |= 0xC0;
-
-    //===========
-    // updates to the media independent header
-    // reverse the source and destination EID values
-    uint8_t source_eid = mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID];
-    uint8_t dest_eid = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-    mctp_buffer[OFFSET_SOURCE_ENDPOINT_ID] = dest_eid;
-    mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID] = source_eid;
-
-    // recalculate the byte count
-    mctp_buffer[OFFSET_BYTE_COUNT] = idx - OFFSET_BYTE_COUNT - 1;
-
-    //==========
-    // calculate the FCS
-    uint16_t fcs = calc_fcs(INITFCS, mctp_buffer + 1, idx - 1);
-    mctp_buffer[idx++] = (fcs >> 8);
-    mctp_buffer[idx++] = (fcs & 0x00FF);
-
-    // add the frame end character
-    mctp_buffer[idx++] = FRAME_CHAR;
-
-    mctp_send_frame();
+    ep->buffer[idx++] = CONTROL_COMPLETE_UNSUPPORTED_CMD;
+    send_control_response(ep, idx);
 }
 
 /**********************************************************************************
  * public functions.  These are visible outside this file.
  **********************************************************************************/
 /**
- * @brief Initialize MCTP framer state.
+ * @brief Initialize an endpoint.
  *
  * Resets the receiver state machine and buffer index to prepare for
- * receiving frames.  Initializes platform hardware as needed.
+ * receiving frames, abandons any frame or queued events still waiting to be
+ * transmitted, and clears the statistics, then initializes the endpoint's
+ * platform.  The endpoint ID assigned by the bus owner is kept across
+ * re-initialization, so `ep` must start out zeroed (static storage, or
+ * memset()) to begin unprogrammed.
  *
+ * @param ep Endpoint to initialize.
+ * @param ops Serial link and clock of the endpoint; must outlive it.
+ * @param platform Argument passed to every `ops` call, e.g. the port to use.
  */
-void mctp_init() {
-    rxState = MCTPSER_WAITING_FOR_SYNC;
-    buffer_idx = 0;
+void mctp_init_ctx(mctp_endpoint_t* ep, const mctp_platform_ops_t* ops, void* platform) {
+    ep->ops = ops;
+    ep->platform = platform;
+    ep->rx_state = MCTPSER_WAITING_FOR_SYNC;
+    ep->buffer_idx = 0;
+    ep->sync_discards = 0;
+    ep->tx_unit = BASELINE_TRANSMISSION_UNIT;
+    ep->current_tx_slot = 0;
+#if MCTP_FULL_DUPLEX_ENABLED
+    ep->tx_response_pending = 0;
+#endif
+#if !MCTP_RX_QUEUE_DEPTH && (MCTP_FULL_DUPLEX_ENABLED || MCTP_REASSEMBLY_ENABLED)
+    ep->rx_chunk_len = 0;
+    ep->rx_chunk_pos = 0;
+#endif
+#if MCTP_RX_QUEUE_DEPTH
+    ep->rx_framer_state = MCTPSER_WAITING_FOR_SYNC;
+    ep->rx_queue_head = 0;
+    ep->rx_queue_tail = 0;
+    ep->rx_queue_count = 0;
+    ep->rx_queue_high_water = 0;
+    ep->rx_queue_drops = 0;
+#endif
+#if MCTP_EVENT_TX_ENABLED
+    ep->event_head = 0;
+    ep->event_count = 0;
+    ep->event_arena_next = 0;
+    ep->event_reserved = 0;
+    ep->event_high_water = 0;
+    ep->event_drops = 0;
+    ep->tx_last_slot = 0;
+    ep->tx_response_waited = 0;
+#endif
+#if MCTP_RX_RING_ENABLED
+    (void)mctp_ring_init(&ep->rx_ring, ep->rx_ring_storage, MCTP_RX_RING_SIZE);
+#endif
+#if MCTP_REASSEMBLY_ENABLED
+    mctp_reasm_init(&ep->rx_reasm);
+    ep->reasm_current = MCTP_REASM_MESSAGES;
+#endif
+#if MCTP_FRAGMENTATION_ENABLED
+    ep->tx_msg.active = 0;
+#endif
+#if MCTP_RESPONSE_TEMPLATES_ENABLED
+    response_templates_init(ep);
+#endif
 
     /* Set up mctp-related hardware */
-    platform_init();
+    if (ops->init != NULL) {
+        ops->init(platform);
+    }
 }
 
+#if MCTP_RX_QUEUE_DEPTH
 /**
- * @brief Process incoming serial data and advance the framer state.
+ * @brief Queue the frame just completed in the assembly slot.
  *
- * Called regularly from the main loop; reads bytes from the platform
- * serial interface when available and updates internal receive state.
+ * Counts the frame as dropped when MCTP_RX_QUEUE_DEPTH frames are already
+ * waiting; the assembly slot is then reused for the next frame.
  *
+ * @param ep Endpoint.
  */
-void mctp_update() {
-    uint8_t byte_value;
-    if (rxState == SENDING_RESPONSE) {
-         mctp_send_frame(); 
-         return; 
+static void rx_queue_push(mctp_endpoint_t* ep) {
+    if (ep->rx_queue_count == MCTP_RX_QUEUE_DEPTH) {
+        ep->rx_queue_drops++;
+        return;
     }
-        if (rxState == MCTPSER_AWAITING_RESPONSE) {
-            /* If a complete frame has been received and we're awaiting
-              response transmission, consume any remaining bytes in the
-              platform RX buffer so callers that loop on
-              platform_serial_has_data() will not spin indefinitely. */
-            while (platform_serial_has_data()) {
-               (void)platform_serial_read_byte();
-            }
-            return;
-        }
-    if (!platform_serial_has_data()) {
+    ep->rx_slot_len[ep->rx_queue_tail] = ep->rx_framer_idx;
+    ep->rx_queue_tail = (uint8_t)((ep->rx_queue_tail + 1) % RX_QUEUE_SLOTS);
+    ep->rx_queue_count++;
+    if (ep->rx_queue_count > ep->rx_queue_high_water) {
+        ep->rx_queue_high_water = ep->rx_queue_count;
+    }
+}
+
+/**
+ * @brief Hand the oldest queued frame to the application.
+ *
+ * Copies the frame into the packet buffer once the application has finished with
+ * the previous one (responded to it, or ignored it).
+ *
+ * @param ep Endpoint.
+ */
+static void rx_queue_deliver(mctp_endpoint_t* ep) {
+    if ((ep->rx_state != MCTPSER_WAITING_FOR_SYNC) || (ep->rx_queue_count == 0)) {
         return;
     }
-    byte_value = platform_serial_read_byte();
-    switch (rxState) {
+    ep->buffer_idx = ep->rx_slot_len[ep->rx_queue_head];
+    memcpy(ep->buffer, ep->rx_slots[ep->rx_queue_head], ep->buffer_idx);
+    ep->rx_queue_head = (uint8_t)((ep->rx_queue_head + 1) % RX_QUEUE_SLOTS);
+    ep->rx_queue_count--;
+    ep->rx_state = MCTPSER_AWAITING_RESPONSE;
+}
+#endif
+
+/**
+ * @brief Advance the receive state machine by one serial byte.
+ *
+ * @param ep Endpoint that received the byte.
+ * @param byte_value The byte received from the serial interface.
+ */
+#ifdef UNIT_TEST
+void mctp_rx_byte(mctp_endpoint_t* ep, uint8_t byte_value) { /* exposed to tests */
+#else
+static void mctp_rx_byte(mctp_endpoint_t* ep, uint8_t byte_value) {
+#endif
+    switch (RX_STATE(ep)) {
         case MCTPSER_WAITING_FOR_SYNC:
             if (byte_value == FRAME_CHAR) {
-                byte_count = 0;
-                buffer_idx = 0;
-                mctp_buffer[buffer_idx++] = FRAME_CHAR;
-                rxState = MCTPSER_HEADER1;
+                ep->byte_count = 0;
+                RX_IDX(ep) = 0;
+                ep->rx_fcs = INITFCS;
+                RX_BUF(ep)[RX_IDX(ep)++] = FRAME_CHAR;
+                RX_STATE(ep) = MCTPSER_HEADER1;
             }
             break;
         case MCTPSER_HEADER1:
             // this should have the protocol version byte.  Just add it to the buffer
-            mctp_buffer[buffer_idx++] = byte_value;
-            rxState = MCTPSER_HEADER2;
+            RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+            ep->rx_fcs = calc_fcs_byte(ep->rx_fcs, byte_value);
+            RX_STATE(ep) = MCTPSER_HEADER2;
             break;
         case MCTPSER_HEADER2:
             // this should have the length byte.  Add it to the buffer
-            mctp_buffer[buffer_idx++] = byte_value;
-            byte_count = byte_value;  // number of bytes in the body
-
-            // if the body size will push the buffer over its limit, drop the frame
-            if ((uint16_t)(byte_count + buffer_idx + 5) > MCTP_BUFFER_SIZE) {
-                rxState = MCTPSER_WAITING_FOR_SYNC;
+            RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+            ep->rx_fcs = calc_fcs_byte(ep->rx_fcs, byte_value);
+            ep->byte_count = byte_value;  // number of bytes in the body
+
+            // if the body cannot hold a transport header, or the frame (header, body, fcs and
+            // trailer) will not fit the buffer, drop it
+            if ((ep->byte_count < MIN_BYTE_COUNT) ||
+                ((uint16_t)(ep->byte_count + 6) > MCTP_BUFFER_SIZE)) {
+                RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
                 break;
             }
-            rxState = MCTPSER_BODY;
+            RX_STATE(ep) = MCTPSER_BODY;
             break;
         case MCTPSER_BODY:
             if (byte_value == ESCAPE_CHAR) {
                 // the next byte is escaped and needs to be unescaped
-                rxState = MCTPSER_ESCAPE;
+                RX_STATE(ep) = MCTPSER_ESCAPE;
                 break;
             } else if (byte_value == FRAME_CHAR) {
                 // unexpected FRAME_CHAR - restart frame
-                byte_count = 0;
-                buffer_idx = 0;
-                mctp_buffer[buffer_idx++] = FRAME_CHAR;
-                rxState = MCTPSER_HEADER1;
+                ep->byte_count = 0;
+                RX_IDX(ep) = 0;
+                ep->rx_fcs = INITFCS;
+                RX_BUF(ep)[RX_IDX(ep)++] = FRAME_CHAR;
+                RX_STATE(ep) = MCTPSER_HEADER1;
                 break;
             } else {
                 // this is a regular byte - add it to the buffer
-                mctp_buffer[buffer_idx++] = byte_value;
+                RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+                ep->rx_fcs = calc_fcs_byte(ep->rx_fcs, byte_value);
                 // keep track of how many bytes are left in the body
-                byte_count--;
-                if (byte_count == 0) {
-                    rxState = MCTPSER_FCS1;
+                ep->byte_count--;
+                if (ep->byte_count == 0) {
+                    RX_STATE(ep) = MCTPSER_FCS1;
                 }
             }
             break;
         case MCTPSER_FCS1:
-            mctp_buffer[buffer_idx++] = byte_value;
-            rxState = MCTPSER_FCS2;
+            RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+            RX_STATE(ep) = MCTPSER_FCS2;
             break;
         case MCTPSER_FCS2:
-            mctp_buffer[buffer_idx++] = byte_value;
-            rxState = MCTPSER_END;
+            RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+            RX_STATE(ep) = MCTPSER_END;
             break;
         case MCTPSER_END:
             if (byte_value != FRAME_CHAR) {
                 // invalid end of frame - drop it
-                rxState = MCTPSER_WAITING_FOR_SYNC;
+                RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
                 break;
             }
-            mctp_buffer[buffer_idx++] = byte_value;
+            RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
 
             // complete frame received - validate it
-            if (validate_rx()) {
+            if (validate_rx(ep)) {
                 /* Only accept frames addressed to this endpoint (or broadcast/all endpoints)
                    Destination EID must be 0x00 (broadcast), 0xFF (all endpoints),
                    or match the configured `endpoint_id`. Otherwise drop the frame. */
-                uint8_t dest = mctp_buffer[OFFSET_DESTINATION_ENDPOINT_ID];
-                if ((dest == 0x00) || (dest == 0xFF) || (dest == endpoint_id)) {
-                    rxState = MCTPSER_AWAITING_RESPONSE;
+                uint8_t dest = RX_BUF(ep)[OFFSET_DESTINATION_ENDPOINT_ID];
+                if ((dest == 0x00) || (dest == 0xFF) || (dest == ep->endpoint_id)) {
+#if MCTP_RX_QUEUE_DEPTH
+                    rx_queue_push(ep);
+                    RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
+#else
+                    RX_STATE(ep) = MCTPSER_AWAITING_RESPONSE;
+#endif
                 } else {
-                    rxState = MCTPSER_WAITING_FOR_SYNC;
+                    RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
                 }
             } else {
-                rxState = MCTPSER_WAITING_FOR_SYNC;
+                RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
             }
             break;
         case MCTPSER_ESCAPE:
             if ((byte_value == (ESCAPE_CHAR - 0x20)) || (byte_value == (FRAME_CHAR - 0x20))) {
                 byte_value = (uint8_t)(byte_value + 0x20);
-                mctp_buffer[buffer_idx++] = byte_value;
-                byte_count--;
-                if (byte_count == 0) {
-                    rxState = MCTPSER_FCS1;
+                RX_BUF(ep)[RX_IDX(ep)++] = byte_value;
+                ep->rx_fcs = calc_fcs_byte(ep->rx_fcs, byte_value);
+                ep->byte_count--;
+                if (ep->byte_count == 0) {
+                    RX_STATE(ep) = MCTPSER_FCS1;
                 } else {
-                    rxState = MCTPSER_BODY;
+                    RX_STATE(ep) = MCTPSER_BODY;
                 }
                 break;
             } else if (byte_value == FRAME_CHAR) {
                 // UNEXPECTED FRAME_CHAR - restart frame
-                byte_count = 0;
-                buffer_idx = 0;
-                mctp_buffer[buffer_idx++] = FRAME_CHAR;
-                rxState = MCTPSER_HEADER1;
+                ep->byte_count = 0;
+                RX_IDX(ep) = 0;
+                ep->rx_fcs = INITFCS;
+                RX_BUF(ep)[RX_IDX(ep)++] = FRAME_CHAR;
+                RX_STATE(ep) = MCTPSER_HEADER1;
             } else {
                 // invalid escape sequence - drop frame
-                rxState = MCTPSER_WAITING_FOR_SYNC;
+                RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
             }
             break;
         case MCTPSER_AWAITING_RESPONSE:
@@ -649,283 +787,1218 @@ void mctp_update() {
         case SENDING_RESPONSE:
             // continue sending the response frame
             // this state transition will occur after the frame has been completely sent.
-            mctp_send_frame();
+            mctp_tx_pump(ep);
             break;
     }
 }
 
 /**
- * @brief Query whether a complete MCTP packet is available.
- *
- * @return uint8_t Returns 1 if a complete packet is available, 0 otherwise.
- */
-uint8_t mctp_is_packet_available() {
-    return rxState == MCTPSER_AWAITING_RESPONSE;
-}
-
-/**
- * @brief Determine if the available packet is a control packet.
+ * @brief Find the first FRAME_CHAR or ESCAPE_CHAR in a block of received bytes.
  *
- * Control packets have message type 0x00 in the message type field.
+ * Uses 16-byte SSE2 or NEON compares where the target has them and a plain
+ * loop otherwise.
  *
- * @return uint8_t Returns 1 if the available packet is a control packet, 0 otherwise.
+ * @param p Bytes to scan.
+ * @param len Number of bytes to scan.
+ * @return uint16_t Index of the first special character, or `len` when the block is clean.
  */
-uint8_t mctp_is_control_packet() {
-    // control packets have message type 0x00 in byte 0 (after the initial FRAME_CHAR)
-    return (mctp_buffer[OFFSET_MSG_TYPE] & 0x0F) == 0x00;
+static uint16_t mctp_find_special(const uint8_t* p, uint16_t len) {
+    uint16_t i = 0;
+#if defined(__SSE2__)
+    const __m128i frame = _mm_set1_epi8((char)FRAME_CHAR);
+    const __m128i escape = _mm_set1_epi8((char)ESCAPE_CHAR);
+    for (; (uint16_t)(i + 16) <= len; i = (uint16_t)(i + 16)) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(v, frame), _mm_cmpeq_epi8(v, escape));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return (uint16_t)(i + __builtin_ctz((unsigned)mask));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t frame = vdupq_n_u8(FRAME_CHAR);
+    const uint8x16_t escape = vdupq_n_u8(ESCAPE_CHAR);
+    for (; (uint16_t)(i + 16) <= len; i = (uint16_t)(i + 16)) {
+        uint8x16_t v = vld1q_u8(p + i);
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(v, frame), vceqq_u8(v, escape))) != 0) {
+            break;  // the scalar loop below locates the byte within this block
+        }
+    }
+#endif
+    for (; i < len; i++) {
+        if ((p[i] == FRAME_CHAR) || (p[i] == ESCAPE_CHAR)) {
+            break;
+        }
+    }
+    return i;
 }
 
 /**
- * @brief Determine if the available packet is a pldm packet.
+ * @brief Copy the clean run at the start of a received chunk into the frame body.
  *
- * Pldm packets have message type 0x01 in the message type field.
+ * Called in MCTPSER_BODY state.  Bytes up to the next FRAME_CHAR or
+ * ESCAPE_CHAR (bounded by the body bytes still expected) are copied with
+ * memcpy and folded into the FCS in one calc_fcs() call; the special
+ * character itself is left for mctp_rx_byte().  The result is identical to
+ * feeding the run through mctp_rx_byte() one byte at a time.  The copy is
+ * also bounded by the room left in the receive buffer ahead of the FCS and
+ * trailer: should the body still expected not fit (a length byte that got
+ * past the header checks), the frame is dropped instead.
  *
- * @return uint8_t Returns 1 if the available packet is a pldm packet, 0 otherwise.
+ * @param ep Endpoint.
+ * @param p Received bytes, starting at the next body byte.
+ * @param len Number of received bytes available at `p`.
+ * @return uint16_t Number of bytes consumed.
  */
-uint8_t mctp_is_pldm_packet() {
-    // pldm packets have message type 0x01 in byte 0 (after the initial FRAME_CHAR)
-    return (mctp_buffer[OFFSET_MSG_TYPE] & 0x0F) == 0x01;
+static uint16_t mctp_rx_body_run(mctp_endpoint_t* ep, const uint8_t* p, uint16_t len) {
+    uint16_t room = 0;  // body bytes that fit ahead of the FCS and trailer
+    if (RX_IDX(ep) + 3 < MCTP_BUFFER_SIZE) {
+        room = (uint16_t)(MCTP_BUFFER_SIZE - 3 - RX_IDX(ep));
+    }
+    if (ep->byte_count > room) {
+        RX_STATE(ep) = MCTPSER_WAITING_FOR_SYNC;
+        return 0;
+    }
+    // from here on the run is within both the body expected and the room left
+    uint16_t run = (len < ep->byte_count) ? len : ep->byte_count;
+    run = mctp_find_special(p, run);
+    if (run == 0) {
+        return 0;
+    }
+    memcpy(&RX_BUF(ep)[RX_IDX(ep)], p, run);
+    ep->rx_fcs = calc_fcs(ep->rx_fcs, &RX_BUF(ep)[RX_IDX(ep)], run);
+    RX_IDX(ep) = (uint16_t)(RX_IDX(ep) + run);
+    ep->byte_count = (uint8_t)(ep->byte_count - run);
+    if (ep->byte_count == 0) {
+        RX_STATE(ep) = MCTPSER_FCS1;
+    }
+    return run;
 }
 
 /**
- * @brief Ignore the current packet and reset the framer.
- *
- * Resets the receiver state so the next incoming frame can be processed.
+ * @brief Fetch the next chunk of received bytes from the configured source.
  *
+ * @param ep Endpoint.
+ * @param buf Destination for the received bytes.
+ * @param max Maximum number of bytes to copy into `buf`.
+ * @return uint16_t Number of bytes copied into `buf`.
  */
-void mctp_ignore_packet() {
-    // simply reset the framer state to wait for the next packet
-    rxState = MCTPSER_WAITING_FOR_SYNC;
+static uint16_t mctp_rx_fetch(mctp_endpoint_t* ep, uint8_t* buf, uint16_t max) {
+#if MCTP_RX_RING_ENABLED
+    return mctp_ring_read(&ep->rx_ring, buf, max);
+#else
+    return ep->ops->read(ep->platform, buf, max);
+#endif
 }
 
+#if MCTP_REASSEMBLY_ENABLED
 /**
- * @brief Dispatch the received control message to the appropriate handler.
+ * @brief Pass a received packet of a multi-packet message to the reassembler.
  *
- * Examines the control command code and calls the matching
- * process_* helper to build and send the response.
+ * Expires stalled messages, then takes the packet held in the packet buffer when
+ * it opens a message (SOM without EOM) or continues one being assembled.
+ * Such a packet is never reported by mctp_is_packet_available(); the
+ * completed message is read with mctp_get_message() instead.  Any other
+ * packet is handled in place as a single-packet message, as before.
  *
+ * @param ep Endpoint.
  */
-void mctp_process_control_message() {
-    if (mctp_buffer[OFFSET_CTRL_COMMAND_CODE] == CONTROL_MSG_SET_ENDPOINT_ID) {
-        process_set_endpoint_id_control_message();
-    } else if (mctp_buffer[OFFSET_CTRL_COMMAND_CODE] == CONTROL_MSG_GET_ENDPOINT_ID) {
-        process_get_endpoint_id_control_message();
-    } else if (mctp_buffer[OFFSET_CTRL_COMMAND_CODE] == CONTROL_MSG_GET_MCTP_VERSION_SUPPORT) {
-        process_get_mctp_version_support_control_message();
-    } else if (mctp_buffer[OFFSET_CTRL_COMMAND_CODE] == CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT) {
-        process_get_message_type_support_control_message();
-    } else {
-        // unsupported command - ignore it for now
-        process_unsupported_control_message();
+static void mctp_reasm_intercept(mctp_endpoint_t* ep) {
+    uint32_t now = (ep->ops->millis != NULL) ? ep->ops->millis(ep->platform) : 0;
+    (void)mctp_reasm_expire(&ep->rx_reasm, now);
+    if (ep->rx_state != MCTPSER_AWAITING_RESPONSE) {
+        return;
+    }
+    uint8_t flags = ep->buffer[OFFSET_FLAGS];
+    uint8_t src = ep->buffer[OFFSET_SOURCE_ENDPOINT_ID];
+    if ((flags & MCTP_FLAG_SOM) ? (flags & MCTP_FLAG_EOM)
+                                : !mctp_reasm_is_open(&ep->rx_reasm, src, flags)) {
+        return;
     }
+    uint8_t msg_index;
+    (void)mctp_reasm_packet(&ep->rx_reasm, src, flags, &ep->buffer[OFFSET_MSG_TYPE],
+                            (uint16_t)(ep->buffer[OFFSET_BYTE_COUNT] - 4), now, &msg_index);
+    ep->rx_state = MCTPSER_WAITING_FOR_SYNC;
 }
+#endif
 
 /**
- * @brief Send the response frame found within the mctp_buffer.
+ * @brief Feed a chunk of received bytes to the receive state machine.
  *
- * - will attempt to write as many bytes as platform_serial_can_write() allows
- * - caller should call repeatedly (mctp_update will call when awaiting response)
- *
- * @return uint8_t the number of bytes sent in this call.
+ * While waiting for sync the chunk is scanned with memchr() for the next
+ * FRAME_CHAR, so line noise costs one scan rather than one state machine step
+ * per byte.  Clean runs of body bytes are copied in bulk (see
+ * mctp_rx_body_run()); escape pairs and framing bytes go through
+ * mctp_rx_byte().  Stops as soon as a complete frame is held.
  *
+ * @param ep Endpoint.
+ * @param chunk Received bytes.
+ * @param i Index of the first byte to process.
+ * @param count Number of bytes in `chunk`.
+ * @return uint16_t Index of the first byte not consumed.
  */
-uint8_t mctp_send_frame() {
-    uint8_t bytes_sent = 0;
-
-    /* If no active slot, select one. Priority: event slot (if pending) then primary response. */
-    if (current_tx_slot == 0) {
-#if MCTP_EVENT_TX_ENABLED
-        if (tx_event_pending) {
-            current_tx_slot = 2;         /* start event transmit */
-            tx_event_idx = tx_event_idx; /* keep existing index if resuming */
-        } else
-#endif
-            if (rxState == MCTPSER_AWAITING_RESPONSE) {
-            /* initialize primary response transmit */
-            uint16_t body_size = mctp_buffer[OFFSET_BYTE_COUNT];
-            send_total_len = (uint16_t)body_size + 6; /* header + body + fcs + trailer */
-            send_idx = 0;
-            send_escape_pending = 0;
-            rxState = SENDING_RESPONSE;
-            current_tx_slot = 1;
-        } else {
-            return 0; /* nothing to send */
-        }
-    }
-
-    /* send bytes while the platform indicates writes are possible for the active slot */
-    while (1) {
-        /* determine active slot length/check */
-        if (current_tx_slot == 1) {
-            if (send_idx >= send_total_len) break;
-        }
-#if MCTP_EVENT_TX_ENABLED
-        else if (current_tx_slot == 2) {
-            if (tx_event_idx >= tx_event_len) break;
-        }
-#endif
-
-        if (!platform_serial_can_write()) {
-            /* cannot write more now */
-            return bytes_sent;
-        }
-
-        /* Handle escape continuation for active slot */
-        if (current_tx_slot == 1) {
-            if (send_escape_pending) {
-                platform_serial_write_byte(send_pending_byte);
-                send_escape_pending = 0;
-                send_idx++; /* complete original buffer byte */
-                bytes_sent++;
-                continue;
-            }
-
-            uint16_t i = send_idx;
-            uint8_t data = mctp_buffer[i];
-
-            /* header/trailer bytes are transmitted raw; only payload bytes are escaped */
-            uint16_t body_size = mctp_buffer[OFFSET_BYTE_COUNT];
-            if ((i < 3) || (i > (uint16_t)(body_size + 3))) {
-                platform_serial_write_byte(data);
-                send_idx++;
-                bytes_sent++;
-                continue;
-            }
-
-            /* payload bytes: escape FRAME_CHAR and ESCAPE_CHAR */
-            if ((data == FRAME_CHAR) || (data == ESCAPE_CHAR)) {
-                platform_serial_write_byte(ESCAPE_CHAR);
-                send_pending_byte = (uint8_t)(data - 0x20);
-                if (!platform_serial_can_write()) {
-                    send_escape_pending = 1;
-                    return bytes_sent;
-                }
-                platform_serial_write_byte(send_pending_byte);
-                send_idx++;
-                bytes_sent++;
-                continue;
+static uint16_t mctp_rx_chunk(mctp_endpoint_t* ep, const uint8_t* chunk, uint16_t i,
+                              uint16_t count) {
+    while (i < count) {
+        if (RX_STATE(ep) == MCTPSER_WAITING_FOR_SYNC) {
+            // hunt for the next frame start instead of stepping through line noise
+            const uint8_t* sync = (const uint8_t*)memchr(&chunk[i], FRAME_CHAR, count - i);
+            uint16_t skip = sync ? (uint16_t)(sync - &chunk[i]) : (uint16_t)(count - i);
+            ep->sync_discards += skip;
+            i = (uint16_t)(i + skip);
+            if (i == count) {
+                break;
             }
-
-            /* normal payload byte */
-            platform_serial_write_byte(data);
-            send_idx++;
-            bytes_sent++;
         }
-#if MCTP_EVENT_TX_ENABLED
-        else if (current_tx_slot == 2) {
-            if (tx_event_escape_pending) {
-                platform_serial_write_byte(tx_event_pending_byte);
-                tx_event_escape_pending = 0;
-                tx_event_idx++;
-                bytes_sent++;
-                continue;
-            }
-
-            uint16_t i = tx_event_idx;
-            uint8_t data = tx_buf_event[i];
-
-            /* Determine header/body/trailer regions using the length field at offset 2
-             * and avoid escaping header/trailer bytes (same behavior as primary slot).
-             */
-            uint16_t body_size = 0;
-            if (tx_event_len > OFFSET_BYTE_COUNT) {
-                body_size = tx_buf_event[OFFSET_BYTE_COUNT];
-            }
-
-            if ((i < 3) || (i > (uint16_t)(body_size + 3))) {
-                /* header/trailer: send raw */
-                platform_serial_write_byte(data);
-                tx_event_idx++;
-                bytes_sent++;
-                continue;
-            }
-
-            /* payload bytes: escape FRAME_CHAR and ESCAPE_CHAR */
-            if ((data == FRAME_CHAR) || (data == ESCAPE_CHAR)) {
-                platform_serial_write_byte(ESCAPE_CHAR);
-                tx_event_pending_byte = (uint8_t)(data - 0x20);
-                if (!platform_serial_can_write()) {
-                    tx_event_escape_pending = 1;
-                    return bytes_sent;
-                }
-                platform_serial_write_byte(tx_event_pending_byte);
-                tx_event_idx++;
-                bytes_sent++;
+        if (RX_STATE(ep) == MCTPSER_BODY) {
+            uint16_t run = mctp_rx_body_run(ep, &chunk[i], (uint16_t)(count - i));
+            if ((run != 0) || (RX_STATE(ep) != MCTPSER_BODY)) {
+                i = (uint16_t)(i + run);
                 continue;
             }
-
-            /* normal payload byte */
-            platform_serial_write_byte(data);
-            tx_event_idx++;
-            bytes_sent++;
         }
-#endif
-        else {
-            /* unknown slot, bail out */
-            return bytes_sent;
+        mctp_rx_byte(ep, chunk[i++]);
+        if (RX_STATE(ep) == MCTPSER_AWAITING_RESPONSE) {
+            break;
         }
     }
-
-    /* Completed current frame -- clear active slot state */
-    if (current_tx_slot == 1) {
-        send_in_progress = 0;
-        send_idx = 0;
-        send_total_len = 0;
-        send_escape_pending = 0;
-        /* reset the framer state to wait for the next packet */
-        rxState = MCTPSER_WAITING_FOR_SYNC;
-    }
-#if MCTP_EVENT_TX_ENABLED
-    else if (current_tx_slot == 2) {
-        tx_event_pending = 0;
-        tx_event_idx = 0;
-        tx_event_len = 0;
-        tx_event_escape_pending = 0;
-    }
-#endif
-
-    current_tx_slot = 0;
-    return bytes_sent;
+    return i;
 }
 
-
+#if MCTP_RX_QUEUE_DEPTH
 /**
- * @brief Enqueue an event frame for prioritized transmit.
+ * @brief Process incoming serial data and advance the framer state.
  *
- * The event slot is a single prioritized transmit buffer used for
- * asynchronous event/notification frames. This call is non-blocking and
- * will return immediately if the event slot is already occupied.
+ * Called regularly from the main loop.  Transmission is advanced first, then
+ * up to `MCTP_RX_CHUNK_SIZE` bytes are fetched from the platform serial
+ * interface (or the receive ring) and fed to the receive state machine, which
+ * keeps assembling frames into the receive queue whatever the application is
+ * doing.  Finally, once the application is done with the previous frame, the
+ * oldest queued frame is copied into the packet buffer and reported by
+ * mctp_is_packet_available().
  *
- * @param data Pointer to the logical (unescaped) event frame bytes.
- * @param len Length of the frame in bytes.
- * @return int 0 on success, -1 if the event slot is occupied, -2 if the
- *             provided frame is too large for the event buffer.
+ * @param ep Endpoint.
  */
-int mctp_send_event(const uint8_t* data, uint16_t len) {
-#if MCTP_EVENT_TX_ENABLED
-    if (len > MCTP_EVENT_TX_BUF_SIZE) return -2;
-    if (tx_event_pending) return -1;
-    for (uint16_t i = 0; i < len; ++i) tx_buf_event[i] = data[i];
-    tx_event_len = len;
-    tx_event_idx = 0;
-    tx_event_pending = 1;
-    tx_event_escape_pending = 0;
-    return 0;
-#else
-    return -1;
+void mctp_update_ctx(mctp_endpoint_t* ep) {
+    uint8_t chunk[MCTP_RX_CHUNK_SIZE];
+    mctp_tx_pump(ep);
+    (void)mctp_rx_chunk(ep, chunk, 0, mctp_rx_fetch(ep, chunk, sizeof(chunk)));
+    rx_queue_deliver(ep);
+#if MCTP_REASSEMBLY_ENABLED
+    mctp_reasm_intercept(ep);
 #endif
 }
-
+#elif MCTP_FULL_DUPLEX_ENABLED
 /**
- * @brief Return whether the event transmit queue is empty.
+ * @brief Process incoming serial data and advance the framer state.
  *
- * @return uint8_t Returns 1 if the event queue is empty, 0 if an event is pending.
+ * Called regularly from the main loop.  Transmission is advanced first, which
+ * also moves a handed-over response out of the packet buffer (see mctp_tx_pump()),
+ * so the next request is received while the previous response drains.  Up to
+ * `MCTP_RX_CHUNK_SIZE` bytes are then fetched from the platform serial
+ * interface (or the receive ring) and fed to the receive state machine.
+ * Bytes following a complete frame are kept for the next call rather than
+ * discarded; while a received frame waits for the application (or for the
+ * previous response to leave the transmit buffer) nothing more is fetched, so
+ * back-to-back requests stay queued in the platform.
+ *
+ * @param ep Endpoint.
  */
-uint8_t mctp_is_event_queue_empty(void) {
+void mctp_update_ctx(mctp_endpoint_t* ep) {
+    mctp_tx_pump(ep);
+    if ((ep->rx_state == MCTPSER_AWAITING_RESPONSE) || (ep->rx_state == SENDING_RESPONSE)) {
+        return;
+    }
+    if (ep->rx_chunk_pos == ep->rx_chunk_len) {
+        ep->rx_chunk_len = mctp_rx_fetch(ep, ep->rx_chunk, sizeof(ep->rx_chunk));
+        ep->rx_chunk_pos = 0;
+    }
+    ep->rx_chunk_pos = mctp_rx_chunk(ep, ep->rx_chunk, ep->rx_chunk_pos, ep->rx_chunk_len);
+#if MCTP_REASSEMBLY_ENABLED
+    mctp_reasm_intercept(ep);
+#endif
+}
+#else
+/**
+ * @brief Process incoming serial data and advance the framer state.
+ *
+ * Called regularly from the main loop; drains up to `MCTP_RX_CHUNK_SIZE`
+ * bytes per call from the platform serial interface (or the receive ring) and
+ * feeds them to the receive state machine (see mctp_rx_chunk()).  Once a
+ * complete frame is held, the rest of the chunk is discarded since the
+ * endpoint only processes one packet at a time.  With
+ * MCTP_REASSEMBLY_ENABLED, bytes following a packet absorbed by reassembly
+ * are kept for the next call instead, since the next packet of the message
+ * may follow back to back.
+ *
+ * @param ep Endpoint.
+ */
+void mctp_update_ctx(mctp_endpoint_t* ep) {
+    uint8_t chunk[MCTP_RX_CHUNK_SIZE];
+    if (ep->rx_state == SENDING_RESPONSE) {
+        mctp_tx_pump(ep);
+        return;
+    }
+#if MCTP_EVENT_TX_ENABLED || MCTP_FRAGMENTATION_ENABLED
+    /* keep queued events and message packets moving while no response is pending */
+    if ((ep->current_tx_slot != 0) || TX_EVENT_PENDING(ep) || TX_MESSAGE_PENDING(ep)) {
+        mctp_tx_pump(ep);
+    }
+#endif
+    if (ep->rx_state == MCTPSER_AWAITING_RESPONSE) {
+        /* If a complete frame has been received and we're awaiting
+           response transmission, consume any remaining bytes in the
+           platform RX buffer so callers that loop on
+           platform_serial_has_data() will not spin indefinitely. */
+        while (mctp_rx_fetch(ep, chunk, sizeof(chunk)) != 0) {
+        }
+        return;
+    }
+#if MCTP_REASSEMBLY_ENABLED
+    if (ep->rx_chunk_pos == ep->rx_chunk_len) {
+        ep->rx_chunk_len = mctp_rx_fetch(ep, ep->rx_chunk, sizeof(ep->rx_chunk));
+        ep->rx_chunk_pos = 0;
+    }
+    ep->rx_chunk_pos = mctp_rx_chunk(ep, ep->rx_chunk, ep->rx_chunk_pos, ep->rx_chunk_len);
+    mctp_reasm_intercept(ep);
+    if (ep->rx_state == MCTPSER_AWAITING_RESPONSE) {
+        ep->rx_chunk_pos = ep->rx_chunk_len; // handed to the application: discard the rest
+    }
+#else
+    (void)mctp_rx_chunk(ep, chunk, 0, mctp_rx_fetch(ep, chunk, sizeof(chunk)));
+#endif
+}
+#endif
+
+/**
+ * @brief Number of received bytes discarded while hunting for a frame start.
+ *
+ * Counts line noise and the remains of dropped frames skipped in the
+ * waiting-for-sync state since mctp_init().
+ *
+ * @param ep Endpoint.
+ * @return uint32_t Bytes discarded while waiting for FRAME_CHAR.
+ */
+uint32_t mctp_get_sync_discards_ctx(mctp_endpoint_t* ep) {
+    return ep->sync_discards;
+}
+
+/**
+ * @brief Most received frames ever waiting in the receive queue at once.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t High-water mark of the receive queue (0 when the queue is disabled).
+ */
+uint8_t mctp_rx_queue_high_water_ctx(mctp_endpoint_t* ep) {
+#if MCTP_RX_QUEUE_DEPTH
+    return ep->rx_queue_high_water;
+#else
+    (void)ep;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Number of received frames dropped because the receive queue was full.
+ *
+ * @param ep Endpoint.
+ * @return uint32_t Frames dropped (0 when the queue is disabled).
+ */
+uint32_t mctp_rx_queue_drops_ctx(mctp_endpoint_t* ep) {
+#if MCTP_RX_QUEUE_DEPTH
+    return ep->rx_queue_drops;
+#else
+    (void)ep;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Query whether a reassembled multi-packet message is available.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Returns 1 if mctp_get_message() has a message to return, 0 otherwise.
+ */
+uint8_t mctp_is_message_available_ctx(mctp_endpoint_t* ep) {
+#if MCTP_REASSEMBLY_ENABLED
+    uint16_t len;
+    for (uint8_t i = 0; i < MCTP_REASM_MESSAGES; ++i) {
+        if (mctp_reasm_message(&ep->rx_reasm, i, &len) != NULL) {
+            return 1;
+        }
+    }
+#else
+    (void)ep;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Return a reassembled multi-packet message.
+ *
+ * The message stays valid, and is returned again by later calls, until
+ * mctp_release_message() frees it.
+ *
+ * @param ep Endpoint.
+ * @param len Set to the message length, starting with the message type byte.
+ * @param src_eid Set to the source endpoint ID.
+ * @param tag Set to the tag owner bit and message tag, as in the transport flags.
+ * @return const uint8_t* The message, or NULL when none is available.
+ */
+const uint8_t* mctp_get_message_ctx(mctp_endpoint_t* ep, uint16_t* len, uint8_t* src_eid,
+                                    uint8_t* tag) {
+#if MCTP_REASSEMBLY_ENABLED
+    for (uint8_t i = 0; i < MCTP_REASM_MESSAGES; ++i) {
+        const uint8_t* msg = mctp_reasm_message(&ep->rx_reasm, i, len);
+        if (msg != NULL) {
+            *src_eid = ep->rx_reasm.msgs[i].src_eid;
+            *tag = ep->rx_reasm.msgs[i].tag;
+            ep->reasm_current = i;
+            return msg;
+        }
+    }
+#else
+    (void)ep;
+    (void)len;
+    (void)src_eid;
+    (void)tag;
+#endif
+    return NULL;
+}
+
+/**
+ * @brief Free the message last returned by mctp_get_message().
+ *
+ * @param ep Endpoint.
+ */
+void mctp_release_message_ctx(mctp_endpoint_t* ep) {
+#if MCTP_REASSEMBLY_ENABLED
+    mctp_reasm_release(&ep->rx_reasm, ep->reasm_current);
+    ep->reasm_current = MCTP_REASM_MESSAGES;
+#else
+    (void)ep;
+#endif
+}
+
+/**
+ * @brief Return the endpoint ID assigned by the bus owner.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t The endpoint ID, 0 while unprogrammed.
+ */
+uint8_t mctp_get_endpoint_id_ctx(mctp_endpoint_t* ep) {
+    return ep->endpoint_id;
+}
+
+/**
+ * @brief Query whether a complete MCTP packet is available.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Returns 1 if a complete packet is available, 0 otherwise.
+ */
+uint8_t mctp_is_packet_available_ctx(mctp_endpoint_t* ep) {
+    return ep->rx_state == MCTPSER_AWAITING_RESPONSE;
+}
+
+/**
+ * @brief Determine if the available packet is a control packet.
+ *
+ * Control packets have message type 0x00 in the message type field.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Returns 1 if the available packet is a control packet, 0 otherwise.
+ */
+uint8_t mctp_is_control_packet_ctx(mctp_endpoint_t* ep) {
+    // control packets have message type 0x00 in byte 0 (after the initial FRAME_CHAR)
+    return (ep->buffer[OFFSET_MSG_TYPE] & 0x0F) == 0x00;
+}
+
+/**
+ * @brief Determine if the available packet is a pldm packet.
+ *
+ * Pldm packets have message type 0x01 in the message type field.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Returns 1 if the available packet is a pldm packet, 0 otherwise.
+ */
+uint8_t mctp_is_pldm_packet_ctx(mctp_endpoint_t* ep) {
+    // pldm packets have message type 0x01 in byte 0 (after the initial FRAME_CHAR)
+    return (ep->buffer[OFFSET_MSG_TYPE] & 0x0F) == 0x01;
+}
+
+/**
+ * @brief Ignore the current packet and reset the framer.
+ *
+ * Resets the receiver state so the next incoming frame can be processed.
+ *
+ * @param ep Endpoint.
+ */
+void mctp_ignore_packet_ctx(mctp_endpoint_t* ep) {
+    // simply reset the framer state to wait for the next packet
+    ep->rx_state = MCTPSER_WAITING_FOR_SYNC;
+}
+
+/**
+ * @brief Access the message of the received packet, to be answered in place.
+ *
+ * For PLDM and vendor handlers: the request starts with its message type
+ * byte, and the response is written over it (up to MCTP_TRANSMISSION_UNIT - 4
+ * bytes, message type byte included) before calling mctp_send_response().
+ *
+ * @param ep Endpoint.
+ * @param len Set to the length of the request message.
+ * @return uint8_t* The message, or NULL when no packet is available.
+ */
+uint8_t* mctp_get_request_ctx(mctp_endpoint_t* ep, uint16_t* len) {
+    if (!mctp_is_packet_available_ctx(ep)) {
+        return NULL;
+    }
+    *len = (uint16_t)(ep->buffer[OFFSET_BYTE_COUNT] - 4);
+    return &ep->buffer[OFFSET_MSG_TYPE];
+}
+
+/**
+ * @brief Send the response written over the request by mctp_get_request().
+ *
+ * Builds the response transport header from the request's, adds the byte
+ * count, FCS and framing, and starts transmission as mctp_send_frame()
+ * does.  Message-level header fields (such as the PLDM Rq bit) are the
+ * caller's.
+ *
+ * @param ep Endpoint.
+ * @param len Length of the response message, message type byte included.
+ * @return int 0 on success, -1 when no packet is available or `len` does not fit.
+ */
+int mctp_send_response_ctx(mctp_endpoint_t* ep, uint16_t len) {
+    if (!mctp_is_packet_available_ctx(ep) || (len == 0) || (len > MCTP_TRANSMISSION_UNIT - 4)) {
+        return -1;
+    }
+    finalize_response(ep, (uint16_t)(OFFSET_MSG_TYPE + len), NULL);
+    return 0;
+}
+
+/**
+ * @brief Dispatch the received control message to the appropriate handler.
+ *
+ * Looks the control command code up in `mctp_control_handlers` and calls
+ * the handler found there to build and send the response; commands without
+ * a handler get an unsupported command response.
+ *
+ * @param ep Endpoint.
+ */
+void mctp_process_control_message_ctx(mctp_endpoint_t* ep) {
+    uint8_t command = ep->buffer[OFFSET_CTRL_COMMAND_CODE];
+    mctp_control_handler_t handler = NULL;
+    if (command < MCTP_CONTROL_COMMANDS) {
+        handler = mctp_control_handlers[command];
+    }
+    if (handler != NULL) {
+        handler(ep);
+    } else {
+        process_unsupported_control_message(ep);
+    }
+}
+
+/**
+ * @brief Start transmitting a logical (unescaped) frame from a cursor.
+ *
+ * @param c Cursor to initialize.
+ * @param buf Frame bytes; must remain valid until the frame has been sent.
+ * @param len Frame length in bytes.
+ */
+static void tx_cursor_start(struct mctp_tx_cursor* c, const uint8_t* buf, uint16_t len) {
+    uint16_t body_size = (len > OFFSET_BYTE_COUNT) ? buf[OFFSET_BYTE_COUNT] : 0;
+    c->buf = buf;
+    c->len = len;
+    c->idx = 0;
+    c->escape_end = (uint16_t)(body_size + 4);
+    c->escape_pending = 0;
+}
+
+#if MCTP_TX_STAGING_ENABLED
+/**
+ * @brief Build the escaped on-wire image of a logical frame in `tx_staging`.
+ *
+ * Payload runs without FRAME_CHAR or ESCAPE_CHAR are copied with memcpy;
+ * special characters become escape pairs.  The region escaped is the same as
+ * for frames sent through tx_cursor_send().
+ *
+ * @param ep Endpoint.
+ * @param frame Logical frame bytes.
+ * @param len Logical frame length in bytes.
+ * @return uint16_t Length of the on-wire image.
+ */
+static uint16_t tx_stage_frame(mctp_endpoint_t* ep, const uint8_t* frame, uint16_t len) {
+    uint16_t escape_end = (uint16_t)(frame[OFFSET_BYTE_COUNT] + 4);
+    uint16_t out = 3;
+    uint16_t i = 3;
+    if (escape_end > len) escape_end = len;
+    memcpy(ep->tx_staging, frame, 3);
+    while (i < escape_end) {
+        uint16_t run = mctp_find_special(&frame[i], (uint16_t)(escape_end - i));
+        memcpy(&ep->tx_staging[out], &frame[i], run);
+        out = (uint16_t)(out + run);
+        i = (uint16_t)(i + run);
+        if (i < escape_end) {
+            ep->tx_staging[out++] = ESCAPE_CHAR;
+            ep->tx_staging[out++] = (uint8_t)(frame[i++] - 0x20);
+        }
+    }
+    memcpy(&ep->tx_staging[out], &frame[i], (size_t)(len - i));
+    return (uint16_t)(out + len - i);
+}
+#endif
+
+/**
+ * @brief Push as much of a cursor's frame as the platform accepts.
+ *
+ * Header and trailer bytes are written raw, and the payload is written as
+ * runs of bytes that need no escaping, so each platform_serial_write() call
+ * covers as many bytes as possible.  FRAME_CHAR and ESCAPE_CHAR payload bytes
+ * are sent as an escape pair; when only the ESCAPE_CHAR is accepted the
+ * second byte is remembered and sent first on the next call.
+ *
+ * @param ep Endpoint.
+ * @param c Cursor of the frame being transmitted.
+ * @return uint16_t Number of frame bytes completed (an escape pair counts as one).
+ */
+static uint16_t tx_cursor_send(mctp_endpoint_t* ep, struct mctp_tx_cursor* c) {
+    uint16_t sent = 0;
+    while (c->idx < c->len) {
+        if (c->escape_pending) {
+            if (ep->ops->write(ep->platform, &c->pending_byte, 1) == 0) {
+                break;
+            }
+            c->escape_pending = 0;
+            c->idx++;
+            sent++;
+            continue;
+        }
+
+        /* header/trailer bytes are transmitted raw; only payload bytes are escaped */
+        uint16_t run;
+        if (c->idx >= c->escape_end) {
+            run = (uint16_t)(c->len - c->idx); /* trailer, or a pre-escaped frame */
+        } else if (c->idx < 3) {
+            run = (uint16_t)(3 - c->idx);
+        } else {
+            uint16_t run_end = (c->escape_end < c->len) ? c->escape_end : c->len;
+            run = mctp_find_special(&c->buf[c->idx], (uint16_t)(run_end - c->idx));
+        }
+
+        if (run != 0) {
+            uint16_t n = ep->ops->write(ep->platform, &c->buf[c->idx], run);
+            c->idx = (uint16_t)(c->idx + n);
+            sent = (uint16_t)(sent + n);
+            if (n < run) {
+                break;
+            }
+            continue;
+        }
+
+        /* payload FRAME_CHAR or ESCAPE_CHAR: send the escape pair */
+        const uint8_t escape = ESCAPE_CHAR;
+        if (ep->ops->write(ep->platform, &escape, 1) == 0) {
+            break;
+        }
+        c->pending_byte = (uint8_t)(c->buf[c->idx] - 0x20);
+        c->escape_pending = 1;
+    }
+    return sent;
+}
+
+#if MCTP_FRAGMENTATION_ENABLED
+/**
+ * @brief Build the next packet of the message being sent in `tx_msg_packet`.
+ *
+ * The packet carries up to the transmission unit less the transport header
+ * (see mctp_set_transmission_unit()) in message bytes, read from the
+ * caller's buffer or callback, with SOM set on the first packet, EOM on the
+ * last, and the packet sequence number counting modulo 4.
+ *
+ * @param ep Endpoint.
+ * @return uint16_t Logical (unescaped) packet length in bytes.
+ */
+static uint16_t tx_message_packet(mctp_endpoint_t* ep) {
+    uint16_t chunk = (uint16_t)(ep->tx_msg.len - ep->tx_msg.offset);
+    uint8_t flags = (uint8_t)(((ep->tx_msg.seq & 0x03) << 4) | (ep->tx_msg.tag & 0x0F));
+    if (chunk > (uint16_t)(ep->tx_unit - 4)) {
+        chunk = (uint16_t)(ep->tx_unit - 4);
+    } else {
+        flags |= 0x40; // EOM
+    }
+    if (ep->tx_msg.offset == 0) {
+        flags |= 0x80; // SOM
+    }
+    uint8_t byte_count = (uint8_t)(chunk + 4);
+    ep->tx_msg_packet[0] = FRAME_CHAR;
+    ep->tx_msg_packet[OFFSET_MSG_MCTP_PROTOCOL_VERSION] = 0x01;
+    ep->tx_msg_packet[OFFSET_BYTE_COUNT] = byte_count;
+    ep->tx_msg_packet[OFFSET_MCTP_HEADER_VERSION] = 0x01;
+    ep->tx_msg_packet[OFFSET_DESTINATION_ENDPOINT_ID] = ep->tx_msg.dest_eid;
+    ep->tx_msg_packet[OFFSET_SOURCE_ENDPOINT_ID] = ep->endpoint_id;
+    ep->tx_msg_packet[OFFSET_FLAGS] = flags;
+    if (ep->tx_msg.data != NULL) {
+        memcpy(&ep->tx_msg_packet[OFFSET_MSG_TYPE], &ep->tx_msg.data[ep->tx_msg.offset], chunk);
+    } else {
+        ep->tx_msg.source(ep->tx_msg.ctx, ep->tx_msg.offset, &ep->tx_msg_packet[OFFSET_MSG_TYPE],
+                          chunk);
+    }
+    uint16_t fcs = calc_fcs(INITFCS, &ep->tx_msg_packet[1], byte_count + 2);
+    ep->tx_msg_packet[byte_count + 3] = (uint8_t)(fcs >> 8);
+    ep->tx_msg_packet[byte_count + 4] = (uint8_t)(fcs & 0x00FF);
+    ep->tx_msg_packet[byte_count + 5] = FRAME_CHAR;
+    return (uint16_t)(byte_count + 6);
+}
+
+/**
+ * @brief Advance the message being sent past the packet just transmitted.
+ *
+ * @param ep Endpoint.
+ */
+static void tx_message_packet_done(mctp_endpoint_t* ep) {
+    ep->tx_msg.offset = (uint16_t)(ep->tx_msg.offset + ep->tx_msg_packet[OFFSET_BYTE_COUNT] - 4);
+    ep->tx_msg.seq = (uint8_t)((ep->tx_msg.seq + 1) & 0x03);
+    if (ep->tx_msg.offset >= ep->tx_msg.len) {
+        ep->tx_msg.active = 0;
+    }
+}
+#endif
+
+/**
+ * @brief Choose the frame to transmit next, according to MCTP_TX_SCHED.
+ *
+ * The primary response is ready once mctp_send_frame() has handed it over
+ * (and, in full-duplex mode, it has been moved to the transmit buffer);
+ * an event is ready when the head of the queue has been committed.  Packets
+ * of a message sent with mctp_send_message() are scheduled as responses,
+ * after a primary response that is ready.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t slot to start: 0 = none, 1 = primary response, 2 = head event,
+ *                 3 = next message packet.
+ */
+static uint8_t tx_select_slot(mctp_endpoint_t* ep) {
+    uint8_t response_slot = TX_RESPONSE_READY(ep) ? 1 : (TX_MESSAGE_PENDING(ep) ? 3 : 0);
 #if MCTP_EVENT_TX_ENABLED
-    return tx_event_pending ? 0 : 1;
+    uint8_t event_ready = (ep->event_count != 0) && ep->event_queue[ep->event_head].committed;
+    if (event_ready && (response_slot != 0)) {
+#if MCTP_TX_SCHED == MCTP_TX_SCHED_ROUND_ROBIN
+        return ((ep->tx_last_slot == 1) || (ep->tx_last_slot == 3)) ? 2 : response_slot;
+#elif MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE
+        if ((uint32_t)ep->tx_response_waited + ep->event_queue[ep->event_head].len >
+            MCTP_TX_RESPONSE_BUDGET) {
+            return response_slot;
+        }
+#endif
+    }
+    if (event_ready) {
+        return 2;
+    }
+#endif
+    return response_slot;
+}
+
+/**
+ * @brief Move queued frames to the platform, one frame at a time.
+ *
+ * Selects the next frame at a frame boundary (see tx_select_slot()) and sends
+ * as much of the active frame as platform_serial_write() accepts.
+ *
+ * @param ep Endpoint.
+ * @return uint16_t the number of bytes sent in this call.
+ */
+static uint16_t mctp_tx_pump(mctp_endpoint_t* ep) {
+    uint16_t bytes_sent = 0;
+
+#if MCTP_FULL_DUPLEX_ENABLED
+    /* free the packet buffer for the next request as soon as the transmit buffer is free */
+    if ((ep->rx_state == SENDING_RESPONSE) && !ep->tx_response_pending) {
+        memcpy(ep->tx_response, ep->buffer, (size_t)ep->buffer[OFFSET_BYTE_COUNT] + 6);
+        ep->tx_response_pending = 1;
+        ep->rx_state = MCTPSER_WAITING_FOR_SYNC;
+#if MCTP_EVENT_TX_ENABLED && (MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE)
+        ep->tx_response_waited = 0;
+#endif
+    }
+#endif
+
+    /* If no active slot, select one according to the scheduling policy. */
+    if (ep->current_tx_slot == 0) {
+        uint8_t slot = tx_select_slot(ep);
+#if MCTP_EVENT_TX_ENABLED
+#if MCTP_TX_SCHED == MCTP_TX_SCHED_ROUND_ROBIN
+        ep->tx_last_slot = (slot != 0) ? slot : ep->tx_last_slot;
+#endif
+        if (slot == 2) {
+            const struct mctp_event_entry* e = &ep->event_queue[ep->event_head];
+            tx_cursor_start(&ep->tx_event, &ep->event_arena[e->offset], e->len);
+            ep->current_tx_slot = 2;
+        } else
+#endif
+            if (slot == 1) {
+            /* initialize primary response transmit: header + body + fcs + trailer */
+            uint16_t frame_len = (uint16_t)(TX_RESPONSE_FRAME(ep)[OFFSET_BYTE_COUNT] + 6);
+#if MCTP_TX_STAGING_ENABLED
+            /* escape once up front; the send loop is then a plain copy of the image */
+            tx_cursor_start(&ep->tx_primary, ep->tx_staging,
+                            tx_stage_frame(ep, TX_RESPONSE_FRAME(ep), frame_len));
+            ep->tx_primary.escape_end = 0;
 #else
+            tx_cursor_start(&ep->tx_primary, TX_RESPONSE_FRAME(ep), frame_len);
+#endif
+            ep->current_tx_slot = 1;
+        }
+#if MCTP_FRAGMENTATION_ENABLED
+        else if (slot == 3) {
+            tx_cursor_start(&ep->tx_fragment, ep->tx_msg_packet, tx_message_packet(ep));
+#if MCTP_EVENT_TX_ENABLED && (MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE)
+            ep->tx_response_waited = 0;
+#endif
+            ep->current_tx_slot = 3;
+        }
+#endif
+        else {
+            return 0; /* nothing to send */
+        }
+    }
+
+    /* send bytes while the platform accepts them for the active slot */
+    if (ep->current_tx_slot == 1) {
+        bytes_sent = tx_cursor_send(ep, &ep->tx_primary);
+        if (ep->tx_primary.idx < ep->tx_primary.len) {
+            return bytes_sent;
+        }
+#if MCTP_FULL_DUPLEX_ENABLED
+        /* Completed current frame -- the transmit buffer can take the next response */
+        ep->tx_response_pending = 0;
+#else
+        /* Completed current frame -- reset the framer state to wait for the next packet */
+        ep->rx_state = MCTPSER_WAITING_FOR_SYNC;
+#endif
+    }
+#if MCTP_EVENT_TX_ENABLED
+    else if (ep->current_tx_slot == 2) {
+        bytes_sent = tx_cursor_send(ep, &ep->tx_event);
+#if MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE
+        if (TX_RESPONSE_READY(ep) || TX_MESSAGE_PENDING(ep)) {
+            ep->tx_response_waited = (uint16_t)(ep->tx_response_waited + bytes_sent);
+        }
+#endif
+        if (ep->tx_event.idx < ep->tx_event.len) {
+            return bytes_sent;
+        }
+        ep->event_head = (uint8_t)((ep->event_head + 1) % MCTP_EVENT_QUEUE_DEPTH);
+        ep->event_count--;
+    }
+#endif
+#if MCTP_FRAGMENTATION_ENABLED
+    else if (ep->current_tx_slot == 3) {
+        bytes_sent = tx_cursor_send(ep, &ep->tx_fragment);
+        if (ep->tx_fragment.idx < ep->tx_fragment.len) {
+            return bytes_sent;
+        }
+        tx_message_packet_done(ep);
+    }
+#endif
+    else {
+        /* unknown slot, bail out */
+        return bytes_sent;
+    }
+
+    ep->current_tx_slot = 0;
+    return bytes_sent;
+}
+
+/**
+ * @brief Send the response frame found within the packet buffer.
+ *
+ * - hands the response built in the packet buffer over for transmission
+ * - will attempt to write as many bytes as platform_serial_write() accepts
+ * - caller should call repeatedly (mctp_update will call when awaiting response)
+ * - a queued event already on the wire (or selected first by the MCTP_TX_SCHED
+ *   policy) is completed before the response starts; frames are never interleaved
+ * - with MCTP_TX_STAGING_ENABLED the response is escaped into a staging buffer
+ *   when its transmission starts, and counts are in on-wire bytes
+ *
+ * @param ep Endpoint.
+ * @return uint16_t the number of bytes sent in this call.
+ *
+ */
+uint16_t mctp_send_frame_ctx(mctp_endpoint_t* ep) {
+    if (ep->rx_state == MCTPSER_AWAITING_RESPONSE) {
+        ep->rx_state = SENDING_RESPONSE;
+#if MCTP_EVENT_TX_ENABLED && (MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE) && !MCTP_FULL_DUPLEX_ENABLED
+        ep->tx_response_waited = 0;
+#endif
+    }
+    return mctp_tx_pump(ep);
+}
+
+
+#if MCTP_EVENT_TX_ENABLED
+/**
+ * @brief Allocate contiguous arena space for an event frame.
+ *
+ * Frames are packed in queue order; when the space after the newest frame is
+ * too small the allocation wraps to the start of the arena, ahead of the
+ * oldest frame.
+ *
+ * @param ep Endpoint.
+ * @param len Frame length in bytes.
+ * @param offset Receives the arena offset of the allocation.
+ * @return uint8_t 1 on success, 0 when the queue or the arena is full.
+ */
+static uint8_t event_alloc(mctp_endpoint_t* ep, uint16_t len, uint16_t* offset) {
+    if (ep->event_count == 0) {
+        ep->event_arena_next = 0;
+    } else if (ep->event_count >= MCTP_EVENT_QUEUE_DEPTH) {
+        return 0;
+    }
+    uint16_t oldest =
+        (ep->event_count == 0) ? MCTP_EVENT_ARENA_SIZE : ep->event_queue[ep->event_head].offset;
+    if ((ep->event_count == 0) || (ep->event_arena_next > oldest)) {
+        /* free space is [next, end) and [0, oldest) */
+        if ((uint16_t)(MCTP_EVENT_ARENA_SIZE - ep->event_arena_next) >= len) {
+            *offset = ep->event_arena_next;
+        } else if (oldest >= len) {
+            *offset = 0;
+        } else {
+            return 0;
+        }
+    } else {
+        /* wrapped: free space is [next, oldest) */
+        if ((uint16_t)(oldest - ep->event_arena_next) < len) {
+            return 0;
+        }
+        *offset = ep->event_arena_next;
+    }
     return 1;
+}
+
+/**
+ * @brief Append an allocated event frame to the transmit queue.
+ *
+ * @param ep Endpoint.
+ * @param offset Arena offset returned by event_alloc().
+ * @param len Frame length in bytes.
+ * @param committed 1 when the frame is complete, 0 for a reservation.
+ */
+static void event_push(mctp_endpoint_t* ep, uint16_t offset, uint16_t len, uint8_t committed) {
+    struct mctp_event_entry* e =
+        &ep->event_queue[(ep->event_head + ep->event_count) % MCTP_EVENT_QUEUE_DEPTH];
+    e->offset = offset;
+    e->len = len;
+    e->committed = committed;
+    ep->event_arena_next = (uint16_t)(offset + len);
+    ep->event_count++;
+    if (ep->event_count > ep->event_high_water) {
+        ep->event_high_water = ep->event_count;
+    }
+}
+#endif
+
+/**
+ * @brief Enqueue an event frame for prioritized transmit.
+ *
+ * Events are queued (up to `MCTP_EVENT_QUEUE_DEPTH` frames packed in an
+ * `MCTP_EVENT_ARENA_SIZE` byte arena) and transmitted in order, ahead of the
+ * primary response at frame boundaries.  This call is non-blocking and
+ * returns immediately if the queue is full; such events are counted by
+ * mctp_event_queue_drops().
+ *
+ * @param ep Endpoint.
+ * @param data Pointer to the logical (unescaped) event frame bytes.
+ * @param len Length of the frame in bytes.
+ * @return int 0 on success, -1 if the event queue is full, -2 if the
+ *             provided frame is larger than MCTP_EVENT_TX_BUF_SIZE.
+ */
+int mctp_send_event_ctx(mctp_endpoint_t* ep, const uint8_t* data, uint16_t len) {
+#if MCTP_EVENT_TX_ENABLED
+    uint16_t offset;
+    if (len > MCTP_EVENT_TX_BUF_SIZE) return -2;
+    if (!event_alloc(ep, len, &offset)) {
+        ep->event_drops++;
+        return -1;
+    }
+    memcpy(&ep->event_arena[offset], data, len);
+    event_push(ep, offset, len, 1);
+    return 0;
+#else
+    (void)ep;
+    (void)data;
+    (void)len;
+    return -1;
 #endif
 }
 
+/**
+ * @brief Reserve queue space for an event and return where its payload goes.
+ *
+ * The application serializes the message (message type byte onwards) directly
+ * into the returned buffer and then calls mctp_event_commit(), which fills in
+ * the framing, transport header and FCS.  The reservation takes its place in
+ * the event queue immediately: events queued after it are sent after it, so
+ * it should be committed promptly.  Only one reservation may be outstanding.
+ *
+ * @param ep Endpoint.
+ * @param len Payload length in bytes.
+ * @return uint8_t* Payload buffer of `len` bytes, or NULL when the queue is full (counted
+ *                  as a drop), the frame would exceed MCTP_EVENT_TX_BUF_SIZE, or a
+ *                  reservation is already outstanding.
+ */
+uint8_t* mctp_event_reserve_ctx(mctp_endpoint_t* ep, uint16_t len) {
+#if MCTP_EVENT_TX_ENABLED
+    uint16_t offset;
+    uint16_t frame_len = (uint16_t)(len + OFFSET_MSG_TYPE + 3); /* header + payload + FCS/trailer */
+    if (ep->event_reserved || (len > 255 - 4) || (frame_len > MCTP_EVENT_TX_BUF_SIZE)) {
+        return NULL;
+    }
+    if (!event_alloc(ep, frame_len, &offset)) {
+        ep->event_drops++;
+        return NULL;
+    }
+    ep->event_reserved_entry =
+        (uint8_t)((ep->event_head + ep->event_count) % MCTP_EVENT_QUEUE_DEPTH);
+    event_push(ep, offset, frame_len, 0);
+    ep->event_reserved = 1;
+    return &ep->event_arena[offset + OFFSET_MSG_TYPE];
+#else
+    (void)ep;
+    (void)len;
+    return NULL;
+#endif
+}
+
+/**
+ * @brief Complete the outstanding reservation and release it for transmit.
+ *
+ * Writes the framing characters, byte count, transport header (this
+ * endpoint as source, SOM/EOM and tag owner set) and FCS around the payload
+ * serialized by the application.
+ *
+ * @param ep Endpoint.
+ * @param dest_eid Destination endpoint id.
+ * @param msg_tag Message tag (0-7).
+ * @return int 0 on success, -1 when no reservation is outstanding.
+ */
+int mctp_event_commit_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t msg_tag) {
+#if MCTP_EVENT_TX_ENABLED
+    if (!ep->event_reserved) {
+        return -1;
+    }
+    struct mctp_event_entry* e = &ep->event_queue[ep->event_reserved_entry];
+    uint8_t* frame = &ep->event_arena[e->offset];
+    uint8_t byte_count = (uint8_t)(e->len - 6);
+    frame[0] = FRAME_CHAR;
+    frame[OFFSET_MSG_MCTP_PROTOCOL_VERSION] = 0x01;
+    frame[OFFSET_BYTE_COUNT] = byte_count;
+    frame[OFFSET_MCTP_HEADER_VERSION] = 0x01;
+    frame[OFFSET_DESTINATION_ENDPOINT_ID] = dest_eid;
+    frame[OFFSET_SOURCE_ENDPOINT_ID] = ep->endpoint_id;
+    frame[OFFSET_FLAGS] = (uint8_t)(0xC0 | 0x08 | (msg_tag & 0x07));  // SOM | EOM | TO | tag
+    uint16_t fcs = calc_fcs(INITFCS, frame + 1, byte_count + 2);
+    frame[e->len - 3] = (uint8_t)(fcs >> 8);
+    frame[e->len - 2] = (uint8_t)(fcs & 0x00FF);
+    frame[e->len - 1] = FRAME_CHAR;
+    e->committed = 1;
+    ep->event_reserved = 0;
+    return 0;
+#else
+    (void)ep;
+    (void)dest_eid;
+    (void)msg_tag;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Return whether the event transmit queue is empty.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Returns 1 if the event queue is empty, 0 if an event is pending.
+ */
+uint8_t mctp_is_event_queue_empty_ctx(mctp_endpoint_t* ep) {
+#if MCTP_EVENT_TX_ENABLED
+    return (ep->event_count == 0) ? 1 : 0;
+#else
+    (void)ep;
+    return 1;
+#endif
+}
+
+/**
+ * @brief Return the largest number of events that have been queued at once.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t Event queue high-water mark (0 when events are disabled).
+ */
+uint8_t mctp_event_queue_high_water_ctx(mctp_endpoint_t* ep) {
+#if MCTP_EVENT_TX_ENABLED
+    return ep->event_high_water;
+#else
+    (void)ep;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Return the number of events refused because the queue was full.
+ *
+ * @param ep Endpoint.
+ * @return uint32_t Dropped event count (0 when events are disabled).
+ */
+uint32_t mctp_event_queue_drops_ctx(mctp_endpoint_t* ep) {
+#if MCTP_EVENT_TX_ENABLED
+    return ep->event_drops;
+#else
+    (void)ep;
+    return 0;
+#endif
+}
+
+
+#if MCTP_FRAGMENTATION_ENABLED
+/**
+ * @brief Start sending a message, unless one is being sent already.
+ *
+ * @param ep Endpoint.
+ * @param dest_eid Destination endpoint id.
+ * @param tag Tag owner bit (0x08) and message tag (0-7), as in the transport flags.
+ * @param len Message length in bytes.
+ * @return int 0 on success, -1 when a message is being sent, -2 when `len` is 0.
+ */
+static int tx_message_start(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t tag, uint16_t len) {
+    if (ep->tx_msg.active) return -1;
+    if (len == 0) return -2;
+    ep->tx_msg.len = len;
+    ep->tx_msg.offset = 0;
+    ep->tx_msg.dest_eid = dest_eid;
+    ep->tx_msg.tag = (uint8_t)(tag & 0x0F);
+    ep->tx_msg.seq = 0;
+    ep->tx_msg.active = 1;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Send a message of any length, split into as many packets as needed.
+ *
+ * The message (message type byte onwards) is read from `msg` one packet at a
+ * time as the packets are transmitted, so the buffer must stay valid and
+ * unchanged until mctp_is_message_sending() returns 0.  Packets are sent by
+ * mctp_update() and scheduled as responses.  When answering a request, the
+ * request is released with mctp_ignore_packet() rather than mctp_send_frame().
+ * This call is non-blocking; only one message is sent at a time.
+ *
+ * @param ep Endpoint.
+ * @param dest_eid Destination endpoint id.
+ * @param tag Tag owner bit (0x08) and message tag (0-7), as in the transport flags;
+ *            a response uses the tag of the request with the tag owner bit clear.
+ * @param msg Message bytes.
+ * @param len Message length in bytes.
+ * @return int 0 on success, -1 when a message is being sent (or fragmentation is
+ *             disabled), -2 when `len` is 0.
+ */
+int mctp_send_message_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t tag, const uint8_t* msg,
+                          uint16_t len) {
+#if MCTP_FRAGMENTATION_ENABLED
+    int r = tx_message_start(ep, dest_eid, tag, len);
+    if (r == 0) {
+        ep->tx_msg.data = msg;
+    }
+    return r;
+#else
+    (void)ep;
+    (void)dest_eid;
+    (void)tag;
+    (void)msg;
+    (void)len;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Send a message of any length whose bytes are produced by a callback.
+ *
+ * As mctp_send_message(), but each packet's share of the message is requested
+ * from `source` when the packet is built, so a large message can be produced
+ * piecewise without ever being held in memory.  `source` is called from
+ * mctp_update() with increasing offsets and must fill all `len` bytes.
+ *
+ * @param ep Endpoint.
+ * @param dest_eid Destination endpoint id.
+ * @param tag Tag owner bit (0x08) and message tag (0-7), as in the transport flags.
+ * @param len Message length in bytes.
+ * @param source Callback supplying the message bytes.
+ * @param ctx Argument passed to `source`.
+ * @return int 0 on success, -1 when a message is being sent (or fragmentation is
+ *             disabled), -2 when `len` is 0.
+ */
+int mctp_send_message_cb_ctx(mctp_endpoint_t* ep, uint8_t dest_eid, uint8_t tag, uint16_t len,
+                             mctp_message_source_t source, void* ctx) {
+#if MCTP_FRAGMENTATION_ENABLED
+    int r = tx_message_start(ep, dest_eid, tag, len);
+    if (r == 0) {
+        ep->tx_msg.data = NULL;
+        ep->tx_msg.source = source;
+        ep->tx_msg.ctx = ctx;
+    }
+    return r;
+#else
+    (void)ep;
+    (void)dest_eid;
+    (void)tag;
+    (void)len;
+    (void)source;
+    (void)ctx;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Return whether a message passed to mctp_send_message() is still being sent.
+ *
+ * @param ep Endpoint.
+ * @return uint8_t 1 while packets of the message remain to be transmitted, otherwise 0.
+ */
+uint8_t mctp_is_message_sending_ctx(mctp_endpoint_t* ep) {
+#if MCTP_FRAGMENTATION_ENABLED
+    return ep->tx_msg.active;
+#else
+    (void)ep;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Set the packet size used for messages sent with mctp_send_message().
+ *
+ * Larger packets carry the same message with fewer framing bytes and FCS
+ * computations, but a peer only accepts them once it has agreed to (for
+ * example through a message-type-specific exchange), so every endpoint starts
+ * at BASELINE_TRANSMISSION_UNIT and mctp_init() returns to it.  Takes effect
+ * from the next packet built.
+ *
+ * @param ep Endpoint.
+ * @param unit Largest byte count (transport header plus payload) per packet,
+ *             from BASELINE_TRANSMISSION_UNIT to MCTP_TRANSMISSION_UNIT.
+ * @return int 0 on success, -1 when `unit` is out of range.
+ */
+int mctp_set_transmission_unit_ctx(mctp_endpoint_t* ep, uint16_t unit) {
+    if ((unit < BASELINE_TRANSMISSION_UNIT) || (unit > MCTP_TRANSMISSION_UNIT)) {
+        return -1;
+    }
+    ep->tx_unit = unit;
+    return 0;
+}
+
+/**
+ * @brief Return the packet size used for messages sent with mctp_send_message().
+ *
+ * @param ep Endpoint.
+ * @return uint16_t Largest byte count (transport header plus payload) per packet.
+ */
+uint16_t mctp_get_transmission_unit_ctx(mctp_endpoint_t* ep) {
+    return ep->tx_unit;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file mctp_default.c
+ * @brief The default endpoint and the single-endpoint API built on it.
+ *
+ * Firmware with one MCTP port calls the functions without a _ctx suffix; they
+ * act on `mctp_default_endpoint`, whose platform ops are the platform_*()
+ * functions of platform.h.  Programs that drive many ports through
+ * mctp_init_ctx() and their own ops can leave this file out, and then need no
+ * platform_*() functions at all.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mctp.h"
+#include "platform.h"
+
+/* weak linkage for optional platform hooks that have a portable default */
+#if defined(__GNUC__)
+#define MCTP_WEAK __attribute__((weak))
+#else
+#define MCTP_WEAK
+#endif
+
+/**
+ * @brief Default bulk read built on the byte-wide platform API.
+ *
+ * Platforms whose UART driver holds a FIFO or DMA buffer should provide
+ * their own `platform_serial_read()`, which replaces this weak definition.
+ *
+ * @param buf Destination for the received bytes.
+ * @param max Maximum number of bytes to copy into `buf`.
+ * @return uint16_t Number of bytes copied into `buf`.
+ */
+MCTP_WEAK uint16_t platform_serial_read(uint8_t* buf, uint16_t max) {
+    uint16_t count = 0;
+    while ((count < max) && platform_serial_has_data()) {
+        buf[count++] = platform_serial_read_byte();
+    }
+    return count;
+}
+
+/**
+ * @brief Default bulk write built on the byte-wide platform API.
+ *
+ * Platforms whose UART driver has a TX FIFO or DMA should provide their own
+ * `platform_serial_write()`, which replaces this weak definition.
+ *
+ * @param buf Bytes to transmit.
+ * @param len Number of bytes in `buf`.
+ * @return uint16_t Number of bytes accepted for transmission.
+ */
+MCTP_WEAK uint16_t platform_serial_write(const uint8_t* buf, uint16_t len) {
+    uint16_t count = 0;
+    while ((count < len) && platform_serial_can_write()) {
+        platform_serial_write_byte(buf[count++]);
+    }
+    return count;
+}
+
+/**
+ * @brief Default clock for platforms without one; reassembly then never times out.
+ *
+ * @return uint32_t Always 0.
+ */
+MCTP_WEAK uint32_t platform_millis(void) {
+    return 0;
+}
+
+/* platform ops of the default endpoint: the platform.h functions, which take no argument */
+static void default_init(void* platform) {
+    (void)platform;
+    platform_init();
+}
+
+static uint16_t default_read(void* platform, uint8_t* buf, uint16_t max) {
+    (void)platform;
+    return platform_serial_read(buf, max);
+}
+
+static uint16_t default_write(void* platform, const uint8_t* buf, uint16_t len) {
+    (void)platform;
+    return platform_serial_write(buf, len);
+}
+
+static uint32_t default_millis(void* platform) {
+    (void)platform;
+    return platform_millis();
+}
+
+static const mctp_platform_ops_t default_ops = {
+    .init = default_init,
+    .read = default_read,
+    .write = default_write,
+    .millis = default_millis,
+};
+
+/* statically set up so that the API behaves before mctp_init() as it always has */
+mctp_endpoint_t mctp_default_endpoint = {
+    .ops = &default_ops,
+    .tx_unit = BASELINE_TRANSMISSION_UNIT,
+#if MCTP_REASSEMBLY_ENABLED
+    .reasm_current = MCTP_REASM_MESSAGES,
+#endif
+};
+
+/* The single-endpoint API; each function is documented with its _ctx form in src/mctp.c. */
+void mctp_init(void) {
+    mctp_init_ctx(&mctp_default_endpoint, &default_ops, NULL);
+}
+
+void mctp_update(void) {
+    mctp_update_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_is_packet_available(void) {
+    return mctp_is_packet_available_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_is_control_packet(void) {
+    return mctp_is_control_packet_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_is_pldm_packet(void) {
+    return mctp_is_pldm_packet_ctx(&mctp_default_endpoint);
+}
+
+void mctp_process_control_message(void) {
+    mctp_process_control_message_ctx(&mctp_default_endpoint);
+}
+
+void mctp_ignore_packet(void) {
+    mctp_ignore_packet_ctx(&mctp_default_endpoint);
+}
+
+uint8_t* mctp_get_request(uint16_t* len) {
+    return mctp_get_request_ctx(&mctp_default_endpoint, len);
+}
+
+int mctp_send_response(uint16_t len) {
+    return mctp_send_response_ctx(&mctp_default_endpoint, len);
+}
+
+uint16_t mctp_send_frame(void) {
+    return mctp_send_frame_ctx(&mctp_default_endpoint);
+}
+
+int mctp_send_event(const uint8_t* data, uint16_t len) {
+    return mctp_send_event_ctx(&mctp_default_endpoint, data, len);
+}
+
+uint8_t* mctp_event_reserve(uint16_t len) {
+    return mctp_event_reserve_ctx(&mctp_default_endpoint, len);
+}
+
+int mctp_event_commit(uint8_t dest_eid, uint8_t msg_tag) {
+    return mctp_event_commit_ctx(&mctp_default_endpoint, dest_eid, msg_tag);
+}
+
+uint8_t mctp_is_event_queue_empty(void) {
+    return mctp_is_event_queue_empty_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_event_queue_high_water(void) {
+    return mctp_event_queue_high_water_ctx(&mctp_default_endpoint);
+}
+
+uint32_t mctp_event_queue_drops(void) {
+    return mctp_event_queue_drops_ctx(&mctp_default_endpoint);
+}
+
+uint32_t mctp_get_sync_discards(void) {
+    return mctp_get_sync_discards_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_rx_queue_high_water(void) {
+    return mctp_rx_queue_high_water_ctx(&mctp_default_endpoint);
+}
+
+uint32_t mctp_rx_queue_drops(void) {
+    return mctp_rx_queue_drops_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_is_message_available(void) {
+    return mctp_is_message_available_ctx(&mctp_default_endpoint);
+}
+
+const uint8_t* mctp_get_message(uint16_t* len, uint8_t* src_eid, uint8_t* tag) {
+    return mctp_get_message_ctx(&mctp_default_endpoint, len, src_eid, tag);
+}
+
+void mctp_release_message(void) {
+    mctp_release_message_ctx(&mctp_default_endpoint);
+}
+
+int mctp_send_message(uint8_t dest_eid, uint8_t tag, const uint8_t* msg, uint16_t len) {
+    return mctp_send_message_ctx(&mctp_default_endpoint, dest_eid, tag, msg, len);
+}
+
+int mctp_send_message_cb(uint8_t dest_eid, uint8_t tag, uint16_t len,
+                         mctp_message_source_t source, void* ctx) {
+    return mctp_send_message_cb_ctx(&mctp_default_endpoint, dest_eid, tag, len, source, ctx);
+}
+
+uint8_t mctp_is_message_sending(void) {
+    return mctp_is_message_sending_ctx(&mctp_default_endpoint);
+}
+
+int mctp_set_transmission_unit(uint16_t unit) {
+    return mctp_set_transmission_unit_ctx(&mctp_default_endpoint, unit);
+}
+
+uint16_t mctp_get_transmission_unit(void) {
+    return mctp_get_transmission_unit_ctx(&mctp_default_endpoint);
+}
+
+uint8_t mctp_get_endpoint_id(void) {
+    return mctp_get_endpoint_id_ctx(&mctp_default_endpoint);
+}
@@ -0,0 +1,354 @@
+/**
+ * @file mctp_linux.c
+ * @brief Linux serial backend: endpoints on tty or pty devices, run from an epoll loop.
+ *
+ * Devices are opened non-blocking and, when they are terminals, switched to
+ * raw 8N1 so the line discipline neither echoes nor translates bytes.  The
+ * read and write ops return 0 instead of blocking, and a short write marks
+ * the port as blocked so the loop waits for writability alone.  Interest in
+ * readability is dropped meanwhile: a half-duplex endpoint does not read while
+ * its response drains, and a level-triggered readable device it will not read
+ * would otherwise wake the loop continuously.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#define _DEFAULT_SOURCE /* cfmakeraw(), cfsetspeed() */
+
+#include "mctp_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#if MCTP_RX_RING_ENABLED
+#error "the Linux backend receives through the platform read op; build it without MCTP_RX_RING_ENABLED"
+#endif
+
+/* ready ports handled per epoll_wait() */
+#define MCTP_LINUX_EVENTS 16
+
+/**
+ * @brief Map a baud rate to its termios speed.
+ *
+ * @param baud Bits per second.
+ * @return speed_t The termios speed, or B0 when the rate is not supported.
+ */
+static speed_t linux_speed(uint32_t baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+        default: return B0;
+    }
+}
+
+/**
+ * @brief Read whatever the device holds, without blocking.
+ *
+ * A device that reports end of file, or fails other than for lack of data,
+ * has hung up; the port is flagged and leaves its loop at the next poll.
+ *
+ * @param platform The mctp_linux_port_t.
+ * @param buf Destination for the received bytes.
+ * @param max Maximum number of bytes to read.
+ * @return uint16_t Bytes read (0 when none are waiting).
+ */
+static uint16_t linux_read(void* platform, uint8_t* buf, uint16_t max) {
+    mctp_linux_port_t* port = (mctp_linux_port_t*)platform;
+    ssize_t n = read(port->fd, buf, max);
+    if (n > 0) {
+        port->moved += (uint32_t)n;
+        return (uint16_t)n;
+    }
+    if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+        port->hangup = 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write as much as the device accepts, without blocking.
+ *
+ * @param platform The mctp_linux_port_t.
+ * @param buf Bytes to transmit.
+ * @param len Number of bytes in `buf`.
+ * @return uint16_t Bytes accepted; fewer than `len` marks the port as blocked.
+ */
+static uint16_t linux_write(void* platform, const uint8_t* buf, uint16_t len) {
+    mctp_linux_port_t* port = (mctp_linux_port_t*)platform;
+    ssize_t n = write(port->fd, buf, len);
+    if (n < 0) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            port->hangup = 1;
+        }
+        n = 0;
+    }
+    if ((uint16_t)n < len) {
+        port->tx_blocked = 1;
+    }
+    port->moved += (uint32_t)n;
+    return (uint16_t)n;
+}
+
+/**
+ * @brief Milliseconds of the monotonic clock.
+ *
+ * @param platform Unused.
+ * @return uint32_t Current time in milliseconds (wraps around).
+ */
+static uint32_t linux_millis(void* platform) {
+    struct timespec ts;
+    (void)platform;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+const mctp_platform_ops_t mctp_linux_ops = {
+    .init = NULL, .read = linux_read, .write = linux_write, .millis = linux_millis};
+
+/**
+ * @brief Take over an open device: make it non-blocking and, for a terminal, raw.
+ *
+ * Terminals (including either side of a pty pair) are set to raw 8N1 with the
+ * receiver enabled and modem control lines ignored.
+ *
+ * @param port Port to set up; any previous state is discarded.
+ * @param fd Open file descriptor, owned by the port from now on.
+ * @param baud Line rate in bits per second, or 0 to leave it unchanged.
+ * @return int 0 on success, -1 with errno set (EINVAL for an unsupported rate).
+ */
+int mctp_linux_attach(mctp_linux_port_t* port, int fd, uint32_t baud) {
+    port->fd = fd;
+    port->epoll_fd = -1;
+    port->ep = NULL;
+    port->handler = NULL;
+    port->events = 0;
+    port->moved = 0;
+    port->tx_blocked = 0;
+    port->hangup = 0;
+
+    int flags = fcntl(fd, F_GETFL);
+    if ((flags < 0) || (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        return -1;
+    }
+    if (!isatty(fd)) {
+        return 0;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    if (baud != 0) {
+        speed_t speed = linux_speed(baud);
+        if (speed == B0) {
+            errno = EINVAL;
+            return -1;
+        }
+        cfsetspeed(&tio, speed);
+    }
+    return tcsetattr(fd, TCSANOW, &tio);
+}
+
+/**
+ * @brief Open a serial device (for example /dev/ttyUSB0 or a pty slave) as a port.
+ *
+ * @param port Port to set up.
+ * @param path Device path.
+ * @param baud Line rate in bits per second, or 0 to leave it unchanged.
+ * @return int 0 on success, -1 with errno set.
+ */
+int mctp_linux_open(mctp_linux_port_t* port, const char* path, uint32_t baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (mctp_linux_attach(port, fd, baud) < 0) {
+        int err = errno;
+        close(fd);
+        port->fd = -1;
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Remove a port from its loop and close its device.
+ *
+ * @param port Port to close.
+ */
+void mctp_linux_close(mctp_linux_port_t* port) {
+    if (port->epoll_fd >= 0) {
+        (void)epoll_ctl(port->epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+        port->epoll_fd = -1;
+    }
+    if (port->fd >= 0) {
+        close(port->fd);
+        port->fd = -1;
+    }
+}
+
+/**
+ * @brief Create an event loop for mctp_linux_add() and mctp_linux_poll().
+ *
+ * @return int The epoll file descriptor, or -1 with errno set.
+ */
+int mctp_linux_loop_create(void) {
+    return epoll_create1(EPOLL_CLOEXEC);
+}
+
+/**
+ * @brief Ask the loop for the events the port needs next.
+ *
+ * Writability alone while transmission is blocked, readability otherwise.
+ *
+ * @param port Port registered with a loop.
+ */
+static void linux_update_interest(mctp_linux_port_t* port) {
+    uint32_t events = port->tx_blocked ? EPOLLOUT : EPOLLIN;
+    if ((port->epoll_fd < 0) || (events == port->events)) {
+        return;
+    }
+    struct epoll_event ev = {.events = events, .data.ptr = port};
+    if (epoll_ctl(port->epoll_fd, EPOLL_CTL_MOD, port->fd, &ev) == 0) {
+        port->events = events;
+    }
+}
+
+/**
+ * @brief Bind an endpoint to a port and register the port with a loop.
+ *
+ * The endpoint (which must be zero-initialized before its first use) is
+ * initialized with mctp_init_ctx() on the port's ops.
+ *
+ * @param epoll_fd Loop from mctp_linux_loop_create().
+ * @param port Port from mctp_linux_open() or mctp_linux_attach().
+ * @param ep Endpoint to run on the port.
+ * @param handler Called after every update of the endpoint; NULL answers
+ *                control requests and drops everything else.
+ * @return int 0 on success, -1 with errno set.
+ */
+int mctp_linux_add(int epoll_fd, mctp_linux_port_t* port, mctp_endpoint_t* ep,
+                   mctp_linux_handler_t handler) {
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = port};
+    port->ep = ep;
+    port->handler = handler;
+    mctp_init_ctx(ep, &mctp_linux_ops, port);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, port->fd, &ev) < 0) {
+        return -1;
+    }
+    port->epoll_fd = epoll_fd;
+    port->events = EPOLLIN;
+    return 0;
+}
+
+/**
+ * @brief Handle received packets the way examples/main.c does.
+ *
+ * @param ep Endpoint.
+ */
+static void linux_default_handler(mctp_endpoint_t* ep) {
+    if (mctp_is_packet_available_ctx(ep)) {
+        if (mctp_is_control_packet_ctx(ep)) {
+            mctp_process_control_message_ctx(ep);
+        } else {
+            mctp_ignore_packet_ctx(ep);
+        }
+    }
+    if (mctp_is_message_available_ctx(ep)) {
+        mctp_release_message_ctx(ep);
+    }
+}
+
+/**
+ * @brief Run a port's endpoint until it can make no more progress.
+ *
+ * Updates the endpoint and calls its handler repeatedly, for as long as
+ * bytes move or a packet or message is delivered, then sets the port's epoll
+ * interest.  mctp_linux_poll() calls this for every ready port; call it
+ * directly after queuing an event or a message from outside the handler.
+ *
+ * @param port Port with an endpoint added by mctp_linux_add().
+ */
+void mctp_linux_service(mctp_linux_port_t* port) {
+    mctp_endpoint_t* ep = port->ep;
+    mctp_linux_handler_t handler = (port->handler != NULL) ? port->handler : linux_default_handler;
+    port->tx_blocked = 0;
+    for (;;) {
+        uint32_t moved = port->moved;
+        mctp_update_ctx(ep);
+        uint8_t received = mctp_is_packet_available_ctx(ep) || mctp_is_message_available_ctx(ep);
+        if (received) {
+            handler(ep);
+        }
+        if ((!received && (port->moved == moved)) || port->hangup) {
+            break;
+        }
+    }
+    linux_update_interest(port);
+}
+
+/**
+ * @brief Wait for ports of a loop to become ready, and service them.
+ *
+ * A port whose device hangs up or fails is serviced once more, removed from
+ * the loop and flagged in `hangup`; its device stays open until
+ * mctp_linux_close().
+ *
+ * @param epoll_fd Loop from mctp_linux_loop_create().
+ * @param timeout_ms Longest wait in milliseconds; -1 waits indefinitely.
+ * @return int Number of ports serviced (0 on timeout or a signal), or -1 with errno set.
+ */
+int mctp_linux_poll(int epoll_fd, int timeout_ms) {
+    struct epoll_event events[MCTP_LINUX_EVENTS];
+    int n = epoll_wait(epoll_fd, events, MCTP_LINUX_EVENTS, timeout_ms);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        mctp_linux_port_t* port = (mctp_linux_port_t*)events[i].data.ptr;
+        mctp_linux_service(port);
+        if ((events[i].events & (EPOLLERR | EPOLLHUP)) || port->hangup) {
+            port->hangup = 1;
+            (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, port->fd, NULL);
+            port->epoll_fd = -1;
+        }
+    }
+    return n;
+}
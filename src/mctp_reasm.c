@@ -0,0 +1,234 @@
+/**
+ * @file mctp_reasm.c
+ * @brief Reassembly of multi-packet MCTP messages.
+ *
+ * Each message owns a fixed region of the arena, so packets are appended with
+ * a single copy and a completed message is contiguous, starting with its
+ * message type byte.  Time is supplied by the caller; with a clock that never
+ * advances timeouts do not fire, and stalled messages are only reclaimed by
+ * eviction when a new message needs their region.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "mctp_reasm.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if (MCTP_REASM_MESSAGES < 1) || (MCTP_REASM_MESSAGES > 255)
+#error "MCTP_REASM_MESSAGES must be between 1 and 255"
+#endif
+
+/* message states */
+#define REASM_FREE 0
+#define REASM_ASSEMBLING 1
+#define REASM_COMPLETE 2
+
+/**
+ * @brief Reset the reassembly context, dropping every message and counter.
+ *
+ * @param r Reassembly context.
+ */
+void mctp_reasm_init(mctp_reasm_t* r) {
+    memset(r->msgs, 0, sizeof(r->msgs));
+    r->next_age = 0;
+    r->sequence_errors = 0;
+    r->timeouts = 0;
+    r->drops = 0;
+}
+
+/**
+ * @brief Find the message being assembled for a source and tag.
+ *
+ * @param r Reassembly context.
+ * @param src_eid Source endpoint ID.
+ * @param tag Tag owner bit and message tag.
+ * @return int Index of the message, or -1 when none is in progress.
+ */
+static int reasm_find(const mctp_reasm_t* r, uint8_t src_eid, uint8_t tag) {
+    for (int i = 0; i < MCTP_REASM_MESSAGES; ++i) {
+        const mctp_reasm_msg_t* m = &r->msgs[i];
+        if ((m->state == REASM_ASSEMBLING) && (m->src_eid == src_eid) && (m->tag == tag)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Pick a region for a new message.
+ *
+ * Uses a free region when there is one; otherwise the oldest message still
+ * being assembled is evicted.  Completed messages are never evicted.
+ *
+ * @param r Reassembly context.
+ * @return int Index of the region, or -1 when every region holds a completed message.
+ */
+static int reasm_alloc(mctp_reasm_t* r) {
+    int oldest = -1;
+    for (int i = 0; i < MCTP_REASM_MESSAGES; ++i) {
+        const mctp_reasm_msg_t* m = &r->msgs[i];
+        if (m->state == REASM_FREE) {
+            return i;
+        }
+        if ((m->state == REASM_ASSEMBLING) &&
+            ((oldest < 0) || ((int16_t)(m->age - r->msgs[oldest].age) < 0))) {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0) {
+        r->drops++;
+    }
+    return oldest;
+}
+
+/**
+ * @brief Add one received packet to the message it belongs to.
+ *
+ * `payload` is the packet body following the transport header: the message
+ * type byte and the start of the message for a SOM packet, continuation
+ * bytes otherwise.  A SOM packet for a source and tag that already has a
+ * message in progress restarts that message.
+ *
+ * @param r Reassembly context.
+ * @param src_eid Source endpoint ID from the transport header.
+ * @param flags Transport header flags byte (SOM, EOM, sequence, TO, tag).
+ * @param payload Packet payload.
+ * @param len Number of payload bytes.
+ * @param now_ms Current time in milliseconds.
+ * @param msg_index Set to the message index when the result is MCTP_REASM_COMPLETE.
+ * @return int MCTP_REASM_PENDING, MCTP_REASM_COMPLETE, or a negative MCTP_REASM_* error.
+ */
+int mctp_reasm_packet(mctp_reasm_t* r, uint8_t src_eid, uint8_t flags, const uint8_t* payload,
+                      uint16_t len, uint32_t now_ms, uint8_t* msg_index) {
+    uint8_t tag = (uint8_t)(flags & (MCTP_FLAG_TO | MCTP_FLAG_TAG_MASK));
+    uint8_t seq = (uint8_t)((flags & MCTP_FLAG_SEQ_MASK) >> MCTP_FLAG_SEQ_SHIFT);
+    int i = reasm_find(r, src_eid, tag);
+    mctp_reasm_msg_t* m;
+
+    if (flags & MCTP_FLAG_SOM) {
+        if (i >= 0) {
+            r->sequence_errors++; /* the previous message never saw its EOM */
+        } else {
+            i = reasm_alloc(r);
+            if (i < 0) {
+                r->drops++;
+                return MCTP_REASM_NO_ROOM;
+            }
+        }
+        m = &r->msgs[i];
+        m->state = REASM_ASSEMBLING;
+        m->src_eid = src_eid;
+        m->tag = tag;
+        m->len = 0;
+        m->age = r->next_age++;
+    } else {
+        if (i < 0) {
+            r->drops++;
+            return MCTP_REASM_UNKNOWN;
+        }
+        m = &r->msgs[i];
+        if (seq != m->next_seq) {
+            m->state = REASM_FREE;
+            r->sequence_errors++;
+            return MCTP_REASM_SEQUENCE;
+        }
+    }
+
+    if ((uint32_t)m->len + len > MCTP_REASM_MAX_MESSAGE) {
+        m->state = REASM_FREE;
+        r->drops++;
+        return MCTP_REASM_TOO_LONG;
+    }
+    memcpy(&r->arena[i][m->len], payload, len);
+    m->len = (uint16_t)(m->len + len);
+    m->next_seq = (uint8_t)((seq + 1) & 0x03);
+    m->last_ms = now_ms;
+
+    if (flags & MCTP_FLAG_EOM) {
+        m->state = REASM_COMPLETE;
+        *msg_index = (uint8_t)i;
+        return MCTP_REASM_COMPLETE;
+    }
+    return MCTP_REASM_PENDING;
+}
+
+/**
+ * @brief Query whether a packet continues a message being assembled.
+ *
+ * @param r Reassembly context.
+ * @param src_eid Source endpoint ID from the transport header.
+ * @param flags Transport header flags byte.
+ * @return uint8_t 1 when a message from `src_eid` with the packet's TO and tag is open.
+ */
+uint8_t mctp_reasm_is_open(const mctp_reasm_t* r, uint8_t src_eid, uint8_t flags) {
+    return reasm_find(r, src_eid, (uint8_t)(flags & (MCTP_FLAG_TO | MCTP_FLAG_TAG_MASK))) >= 0;
+}
+
+/**
+ * @brief Access a completed message.
+ *
+ * @param r Reassembly context.
+ * @param msg_index Index returned with MCTP_REASM_COMPLETE.
+ * @param len Set to the message length, starting with the message type byte.
+ * @return const uint8_t* The message, or NULL when the index holds no completed message.
+ */
+const uint8_t* mctp_reasm_message(const mctp_reasm_t* r, uint8_t msg_index, uint16_t* len) {
+    if ((msg_index >= MCTP_REASM_MESSAGES) || (r->msgs[msg_index].state != REASM_COMPLETE)) {
+        return NULL;
+    }
+    *len = r->msgs[msg_index].len;
+    return r->arena[msg_index];
+}
+
+/**
+ * @brief Free the region of a completed message.
+ *
+ * @param r Reassembly context.
+ * @param msg_index Index returned with MCTP_REASM_COMPLETE.
+ */
+void mctp_reasm_release(mctp_reasm_t* r, uint8_t msg_index) {
+    if (msg_index < MCTP_REASM_MESSAGES) {
+        r->msgs[msg_index].state = REASM_FREE;
+    }
+}
+
+/**
+ * @brief Drop messages whose last packet is older than MCTP_REASM_TIMEOUT_MS.
+ *
+ * @param r Reassembly context.
+ * @param now_ms Current time in milliseconds.
+ * @return uint8_t Number of messages dropped.
+ */
+uint8_t mctp_reasm_expire(mctp_reasm_t* r, uint32_t now_ms) {
+    uint8_t expired = 0;
+    for (int i = 0; i < MCTP_REASM_MESSAGES; ++i) {
+        mctp_reasm_msg_t* m = &r->msgs[i];
+        if ((m->state == REASM_ASSEMBLING) &&
+            ((uint32_t)(now_ms - m->last_ms) > MCTP_REASM_TIMEOUT_MS)) {
+            m->state = REASM_FREE;
+            expired++;
+        }
+    }
+    r->timeouts += expired;
+    return expired;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file mctp_ring.c
+ * @brief Lock-free single-producer/single-consumer byte ring implementation.
+ *
+ * The producer publishes bytes by storing `head` with release ordering after
+ * the data has been written; the consumer observes `head` with acquire
+ * ordering before reading the data and releases the space by storing `tail`.
+ * Without C11 atomics the same ordering is obtained with compiler barriers
+ * around volatile index accesses, which is adequate for an interrupt handler
+ * and a main loop on one core.  Multi-core hosts should build with C11 atomics.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "mctp_ring.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if MCTP_RING_USE_C11_ATOMICS
+#define RING_LOAD_RELAXED(p) atomic_load_explicit((p), memory_order_relaxed)
+#define RING_LOAD_ACQUIRE(p) atomic_load_explicit((p), memory_order_acquire)
+#define RING_STORE_RELEASE(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#define RING_COUNTER_ADD(p, v) atomic_fetch_add_explicit((p), (v), memory_order_relaxed)
+#define RING_COUNTER_LOAD(p) atomic_load_explicit((p), memory_order_relaxed)
+#define RING_COUNTER_CLEAR(p) atomic_store_explicit((p), 0u, memory_order_relaxed)
+#else
+#if defined(__GNUC__)
+#define RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define RING_BARRIER()
+#endif
+#define RING_LOAD_RELAXED(p) (*(p))
+#define RING_LOAD_ACQUIRE(p) ring_load_acquire(p)
+#define RING_STORE_RELEASE(p, v) ring_store_release((p), (v))
+#define RING_COUNTER_ADD(p, v) (*(p) += (v))
+#define RING_COUNTER_LOAD(p) (*(p))
+#define RING_COUNTER_CLEAR(p) (*(p) = 0u)
+
+/**
+ * @brief Load an index, then keep later data accesses after the load.
+ *
+ * @param p Index to load.
+ * @return MCTP_RING_IDX_T The loaded index.
+ */
+static MCTP_RING_IDX_T ring_load_acquire(mctp_ring_idx_t* p) {
+    MCTP_RING_IDX_T v = *p;
+    RING_BARRIER();
+    return v;
+}
+
+/**
+ * @brief Store an index after all earlier data accesses.
+ *
+ * @param p Index to store.
+ * @param v New index value.
+ */
+static void ring_store_release(mctp_ring_idx_t* p, MCTP_RING_IDX_T v) {
+    RING_BARRIER();
+    *p = v;
+}
+#endif
+
+/**
+ * @brief Initialize a ring over caller-provided storage.
+ *
+ * @param r Ring to initialize.
+ * @param storage Backing storage of `size` bytes.
+ * @param size Ring size in bytes; must be a power of two no larger than half the range of
+ *             `MCTP_RING_IDX_T` (128 for uint8_t, 32768 for uint16_t).
+ * @return int 0 on success, -1 when `size` is not usable.
+ */
+int mctp_ring_init(mctp_ring_t* r, uint8_t* storage, uint16_t size) {
+    const uint32_t max_size = ((uint32_t)(MCTP_RING_IDX_T)~0u >> 1) + 1u;
+    if ((size == 0) || ((size & (size - 1u)) != 0) || ((uint32_t)size > max_size)) {
+        return -1;
+    }
+    r->buf = storage;
+    r->mask = (MCTP_RING_IDX_T)(size - 1u);
+    RING_STORE_RELEASE(&r->head, 0);
+    RING_STORE_RELEASE(&r->tail, 0);
+    RING_COUNTER_CLEAR(&r->overflows);
+    return 0;
+}
+
+/**
+ * @brief Append one byte (producer side).
+ *
+ * Intended to be called from the UART receive interrupt.  When the ring is
+ * full the byte is dropped and the overflow counter incremented.
+ *
+ * @param r Ring to append to.
+ * @param b Byte to append.
+ * @return uint8_t 1 when the byte was stored, 0 when it was dropped.
+ */
+uint8_t mctp_ring_put(mctp_ring_t* r, uint8_t b) {
+    MCTP_RING_IDX_T head = RING_LOAD_RELAXED(&r->head);
+    MCTP_RING_IDX_T tail = RING_LOAD_ACQUIRE(&r->tail);
+    if ((MCTP_RING_IDX_T)(head - tail) > r->mask) {
+        RING_COUNTER_ADD(&r->overflows, 1u);
+        return 0;
+    }
+    r->buf[head & r->mask] = b;
+    RING_STORE_RELEASE(&r->head, (MCTP_RING_IDX_T)(head + 1u));
+    return 1;
+}
+
+/**
+ * @brief Append a block of bytes (producer side).
+ *
+ * Intended for DMA completion callbacks.  Bytes that do not fit are dropped
+ * and counted as overflows.
+ *
+ * @param r Ring to append to.
+ * @param data Bytes to append.
+ * @param len Number of bytes in `data`.
+ * @return uint16_t Number of bytes stored.
+ */
+uint16_t mctp_ring_write(mctp_ring_t* r, const uint8_t* data, uint16_t len) {
+    MCTP_RING_IDX_T head = RING_LOAD_RELAXED(&r->head);
+    MCTP_RING_IDX_T tail = RING_LOAD_ACQUIRE(&r->tail);
+    uint16_t space = (uint16_t)(r->mask + 1u - (MCTP_RING_IDX_T)(head - tail));
+    uint16_t count = (len < space) ? len : space;
+    uint16_t offset = (uint16_t)(head & r->mask);
+    uint16_t first = (uint16_t)(r->mask + 1u - offset);
+    if (first > count) first = count;
+    memcpy(&r->buf[offset], data, first);
+    memcpy(r->buf, data + first, (size_t)(count - first));
+    RING_STORE_RELEASE(&r->head, (MCTP_RING_IDX_T)(head + count));
+    if (count < len) {
+        RING_COUNTER_ADD(&r->overflows, (uint32_t)(len - count));
+    }
+    return count;
+}
+
+/**
+ * @brief Remove up to `max` bytes (consumer side).
+ *
+ * @param r Ring to read from.
+ * @param buf Destination for the bytes.
+ * @param max Maximum number of bytes to copy into `buf`.
+ * @return uint16_t Number of bytes copied into `buf`.
+ */
+uint16_t mctp_ring_read(mctp_ring_t* r, uint8_t* buf, uint16_t max) {
+    MCTP_RING_IDX_T tail = RING_LOAD_RELAXED(&r->tail);
+    MCTP_RING_IDX_T head = RING_LOAD_ACQUIRE(&r->head);
+    uint16_t avail = (uint16_t)(MCTP_RING_IDX_T)(head - tail);
+    uint16_t count = (max < avail) ? max : avail;
+    uint16_t offset = (uint16_t)(tail & r->mask);
+    uint16_t first = (uint16_t)(r->mask + 1u - offset);
+    if (first > count) first = count;
+    memcpy(buf, &r->buf[offset], first);
+    memcpy(buf + first, r->buf, (size_t)(count - first));
+    RING_STORE_RELEASE(&r->tail, (MCTP_RING_IDX_T)(tail + count));
+    return count;
+}
+
+/**
+ * @brief Number of bytes waiting in the ring (consumer side).
+ *
+ * @param r Ring to query.
+ * @return uint16_t Number of bytes available to mctp_ring_read().
+ */
+uint16_t mctp_ring_count(mctp_ring_t* r) {
+    MCTP_RING_IDX_T tail = RING_LOAD_RELAXED(&r->tail);
+    MCTP_RING_IDX_T head = RING_LOAD_ACQUIRE(&r->head);
+    return (uint16_t)(MCTP_RING_IDX_T)(head - tail);
+}
+
+/**
+ * @brief Number of bytes dropped because the ring was full.
+ *
+ * @param r Ring to query.
+ * @return uint32_t Total overflowed bytes since mctp_ring_init().
+ */
+uint32_t mctp_ring_overflows(mctp_ring_t* r) {
+    return RING_COUNTER_LOAD(&r->overflows);
+}
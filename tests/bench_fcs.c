@@ -0,0 +1,173 @@
+/**
+ * @file bench_fcs.c
+ * @brief Host benchmark comparing the compile-time FCS implementations.
+ *
+ * The Makefile compiles `src/fcs.c` once per implementation with
+ * `calc_fcs` renamed to `calc_fcs_<variant>` so every variant can be linked
+ * into this single program, together with the carry-less-multiply kernel.
+ * Each variant is checked against the table implementation and then timed
+ * over frame sizes from the minimum MCTP frame (11 bytes) up to
+ * `MCTP_BUFFER_SIZE`, plus a few bulk sizes.  A summary lists the ROM
+ * footprint and cycles/byte of every variant at `MCTP_BUFFER_SIZE`.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* FCS_ROM_<variant>: text + data of each variant object, generated by the Makefile */
+#include "fcs_rom.h"
+
+#ifndef MCTP_BUFFER_SIZE
+#define MCTP_BUFFER_SIZE (64 + 6)
+#endif
+
+/* frames of each size pushed through every variant (scaled down for bulk sizes) */
+#define BENCH_ITERATIONS 200000
+
+/* largest buffer benchmarked */
+#define BENCH_MAX_LEN 4096
+
+/* variants produced by the Makefile (see FCS_VARIANTS) */
+uint16_t calc_fcs_table(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_slice4(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_slice8(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_nibble(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_bitwise(uint16_t f, uint8_t* cp, int len);
+uint16_t calc_fcs_clmul(uint16_t f, uint8_t* cp, int len);
+
+typedef uint16_t (*fcs_fn_t)(uint16_t f, uint8_t* cp, int len);
+struct fcs_variant {
+    const char* name;
+    fcs_fn_t fn;
+    int rom_bytes;
+};
+
+static const struct fcs_variant variants[] = {
+    {"table", calc_fcs_table, FCS_ROM_table},
+    {"slice4", calc_fcs_slice4, FCS_ROM_slice4},
+    {"slice8", calc_fcs_slice8, FCS_ROM_slice8},
+    {"nibble", calc_fcs_nibble, FCS_ROM_nibble},
+    {"bitwise", calc_fcs_bitwise, FCS_ROM_bitwise},
+    {"clmul", calc_fcs_clmul, FCS_ROM_clmul},
+};
+#define NUM_VARIANTS ((int)(sizeof(variants) / sizeof(variants[0])))
+
+/* MCTP frame sizes, followed by bulk sizes seen by host-side bridges */
+static const int frame_sizes[] = {11, 16, 24, 32, 48, 64, MCTP_BUFFER_SIZE, 256, 1024, 4096};
+#define NUM_SIZES ((int)(sizeof(frame_sizes) / sizeof(frame_sizes[0])))
+
+/**
+ * @brief Return a monotonic timestamp in nanoseconds.
+ *
+ * @return uint64_t Current monotonic time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Return a cycle counter where the host provides one.
+ *
+ * @return uint64_t Cycle count, or 0 when no counter is available.
+ */
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Verify every variant against the table implementation.
+ *
+ * @param buf Random test data of at least `BENCH_MAX_LEN` bytes.
+ * @return int 0 when all variants agree, 1 otherwise.
+ */
+static int verify_variants(uint8_t* buf) {
+    for (int v = 1; v < NUM_VARIANTS; ++v) {
+        for (int len = 0; len <= BENCH_MAX_LEN; ++len) {
+            uint16_t expected = calc_fcs_table(0xffff, buf, len);
+            uint16_t actual = variants[v].fn(0xffff, buf, len);
+            if (expected != actual) {
+                printf("MISMATCH %s len=%d exp=0x%04x got=0x%04x\n", variants[v].name, len,
+                       expected, actual);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Benchmark entry point.
+ *
+ * @return int 0 on success, 1 when a variant disagrees with the table.
+ */
+int main(void) {
+    static uint8_t buf[BENCH_MAX_LEN];
+    srand(1);
+    for (int i = 0; i < BENCH_MAX_LEN; ++i) buf[i] = (uint8_t)rand();
+
+    if (verify_variants(buf)) return 1;
+
+    printf("%-8s %6s %12s %12s\n", "variant", "bytes", "ns/byte", "cycles/byte");
+    volatile uint16_t sink = 0;
+    double frame_cycles[NUM_VARIANTS];
+    for (int v = 0; v < NUM_VARIANTS; ++v) {
+        for (int s = 0; s < NUM_SIZES; ++s) {
+            int len = frame_sizes[s];
+            int iterations = BENCH_ITERATIONS;
+            if (len > MCTP_BUFFER_SIZE) iterations = BENCH_ITERATIONS * MCTP_BUFFER_SIZE / len;
+            uint64_t t0 = now_ns();
+            uint64_t c0 = now_cycles();
+            for (int it = 0; it < iterations; ++it) {
+                /* perturb the input so the call cannot be hoisted out of the loop */
+                buf[0] = (uint8_t)it;
+                sink ^= variants[v].fn(0xffff, buf, len);
+            }
+            uint64_t c1 = now_cycles();
+            uint64_t t1 = now_ns();
+            double bytes = (double)iterations * len;
+            printf("%-8s %6d %12.3f %12.3f\n", variants[v].name, len, (double)(t1 - t0) / bytes,
+                   (double)(c1 - c0) / bytes);
+            if (len == MCTP_BUFFER_SIZE) frame_cycles[v] = (double)(c1 - c0) / bytes;
+        }
+    }
+
+    printf("\n%-8s %10s %18s\n", "variant", "ROM bytes", "cycles/byte @ max");
+    for (int v = 0; v < NUM_VARIANTS; ++v) {
+        printf("%-8s %10d %18.3f\n", variants[v].name, variants[v].rom_bytes, frame_cycles[v]);
+    }
+    (void)sink;
+    return 0;
+}
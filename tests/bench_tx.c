@@ -0,0 +1,187 @@
+/**
+ * @file bench_tx.c
+ * @brief Host benchmark of the transmit path in mctp_send_frame().
+ *
+ * The Makefile builds this file three times against `src/mctp.c`:
+ *   - bench_tx_byte:   platform offers only the byte API, so the core's weak
+ *                      platform_serial_write() pushes one byte per can_write poll;
+ *   - bench_tx_bulk:   platform provides platform_serial_write() (a DMA-like sink);
+ *   - bench_tx_staged: as bulk, with MCTP_TX_STAGING_ENABLED=1.
+ * Each build checks its wire image against a reference escaper, then reports
+ * cycles (and ns) per logical frame byte for maximum-size responses with
+ * sparse and dense FRAME_CHAR/ESCAPE_CHAR payloads.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "mctp.h"
+#include "mctp_testhooks.h"
+#include "platform.h"
+
+#ifndef MCTP_BUFFER_SIZE
+#define MCTP_BUFFER_SIZE (64 + 6)
+#endif
+
+#ifndef BENCH_TX_CONFIG
+#define BENCH_TX_CONFIG "unknown"
+#endif
+
+/* frames pushed through mctp_send_frame() per measurement */
+#define BENCH_ITERATIONS 200000
+
+/* DMA-like sink: every frame restarts at the beginning */
+static uint8_t wire[4 * MCTP_BUFFER_SIZE];
+static uint16_t wire_len;
+
+void platform_init(void) {}
+uint8_t platform_serial_has_data(void) { return 0; }
+uint8_t platform_serial_read_byte(void) { return 0; }
+uint16_t platform_serial_read(uint8_t* buf, uint16_t max) {
+    (void)buf;
+    (void)max;
+    return 0;
+}
+uint8_t platform_serial_can_write(void) { return 1; }
+void platform_serial_write_byte(uint8_t b) {
+    wire[wire_len] = b;
+    wire_len = (uint16_t)((wire_len + 1) % sizeof(wire));
+}
+#ifndef BENCH_TX_BYTE_API
+uint16_t platform_serial_write(const uint8_t* buf, uint16_t len) {
+    memcpy(&wire[wire_len], buf, len);
+    wire_len = (uint16_t)((wire_len + len) % sizeof(wire));
+    return len;
+}
+#endif
+
+/**
+ * @brief Return a monotonic timestamp in nanoseconds.
+ *
+ * @return uint64_t Current monotonic time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Return a cycle counter where the host provides one.
+ *
+ * @return uint64_t Cycle count, or 0 when no counter is available.
+ */
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Load a maximum-size response into mctp_buffer.
+ *
+ * @param special_pct Percentage of payload bytes that are FRAME_CHAR or ESCAPE_CHAR.
+ * @return uint16_t Logical frame length.
+ */
+static uint16_t load_frame(int special_pct) {
+    const uint8_t body = MCTP_BUFFER_SIZE - 6;
+    mctp_buffer[0] = 0x7E;
+    mctp_buffer[1] = 0x01;
+    mctp_buffer[2] = body;
+    for (int k = 0; k < body + 2; ++k) {
+        uint8_t b = (uint8_t)(rand() % 0x7C);
+        if (rand() % 100 < special_pct) b = (rand() & 1) ? 0x7E : 0x7D;
+        mctp_buffer[3 + k] = b;
+    }
+    mctp_buffer[body + 5] = 0x7E;
+    return (uint16_t)(body + 6);
+}
+
+/**
+ * @brief Send the frame in mctp_buffer once, to completion.
+ */
+static void send_once(void) {
+    wire_len = 0;
+    rxState = MCTPSER_AWAITING_RESPONSE;
+    while (rxState != MCTPSER_WAITING_FOR_SYNC) mctp_send_frame();
+}
+
+/**
+ * @brief Check the wire image of the frame in mctp_buffer against a reference escaper.
+ *
+ * @param len Logical frame length.
+ * @return int 0 when the image matches, 1 otherwise.
+ */
+static int verify_wire(uint16_t len) {
+    uint8_t expected[sizeof(wire)];
+    uint16_t n = 0;
+    uint16_t escape_end = (uint16_t)(mctp_buffer[2] + 4);
+    for (uint16_t i = 0; i < len; ++i) {
+        uint8_t b = mctp_buffer[i];
+        if ((i >= 3) && (i < escape_end) && ((b == 0x7E) || (b == 0x7D))) {
+            expected[n++] = 0x7D;
+            b = (uint8_t)(b - 0x20);
+        }
+        expected[n++] = b;
+    }
+    send_once();
+    if ((wire_len != n) || (memcmp(expected, wire, n) != 0)) {
+        printf("%s: wire image mismatch\n", BENCH_TX_CONFIG);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Benchmark entry point.
+ *
+ * @return int 0 on success, 1 when the wire image is wrong.
+ */
+int main(void) {
+    static const int densities[] = {1, 25};
+    srand(1);
+    mctp_init();
+    for (unsigned d = 0; d < sizeof(densities) / sizeof(densities[0]); ++d) {
+        uint16_t len = load_frame(densities[d]);
+        if (verify_wire(len)) return 1;
+        uint64_t t0 = now_ns();
+        uint64_t c0 = now_cycles();
+        for (int it = 0; it < BENCH_ITERATIONS; ++it) send_once();
+        uint64_t c1 = now_cycles();
+        uint64_t t1 = now_ns();
+        double bytes = (double)BENCH_ITERATIONS * len;
+        printf("%-7s %3d%% special %12.3f ns/byte %12.3f cycles/byte\n", BENCH_TX_CONFIG,
+               densities[d], (double)(t1 - t0) / bytes, (double)(c1 - c0) / bytes);
+    }
+    return 0;
+}
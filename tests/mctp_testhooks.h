@@ -32,11 +32,23 @@
 
 #include <stdint.h>
 
+#include "mctp.h"
 /* Reuse canonical framer-state definitions from src/ to avoid duplication */
 #include "../src/mctp_framer_states.h"
-/* Internal buffer and state (available to tests) */
-extern uint8_t mctp_buffer[];
-extern uint8_t buffer_idx;
-extern uint8_t rxState;
+/* Internal buffer and state of the default endpoint (available to tests) */
+#define mctp_buffer (mctp_default_endpoint.buffer)
+#define buffer_idx (mctp_default_endpoint.buffer_idx)
+#define rxState (mctp_default_endpoint.rx_state)
+/* state and index of the receive framer, which assembles frames in a queue slot
+ * rather than in `mctp_buffer` when the receive queue is built in */
+#if MCTP_RX_QUEUE_DEPTH
+#define rxFramerState (mctp_default_endpoint.rx_framer_state)
+#define rxFramerIdx (mctp_default_endpoint.rx_framer_idx)
+#else
+#define rxFramerState rxState
+#define rxFramerIdx buffer_idx
+#endif
+/* per-byte receive state machine, the reference for the bulk receive path */
+void mctp_rx_byte(mctp_endpoint_t* ep, uint8_t byte_value);
 
 #endif /* MCTP_TESTHOOKS_H */
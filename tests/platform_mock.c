@@ -6,6 +6,15 @@
  * primitives (`platform_serial_read_byte`, `platform_serial_write_byte`,
  * etc.) which tests drive to simulate RX/TX activity.
  *
+ * mock_uart_enable() replaces the in-memory pipe with a virtual-time UART
+ * model (see platform_mock.h).  Transmitted bytes are scheduled on the line
+ * one character time (plus the configured gap) apart, and the transmit FIFO
+ * only shows free space once the interrupt latency has passed after a byte
+ * left it.  Injected receive bytes arrive on the same schedule; the first byte
+ * into an empty receive FIFO raises an interrupt that moves the FIFO to
+ * software after the interrupt latency, and bytes arriving at a full FIFO
+ * are lost.
+ *
  * @author Douglas Sandy
  *
  * MIT No Attribution
@@ -31,6 +40,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "platform_mock.h"
+
 /* Platform mock state */
 static uint8_t tx_buffer[1024];
 static uint16_t tx_len = 0;
@@ -38,6 +49,29 @@ static uint8_t can_write_state = 1; /* default: writable */
 static uint8_t rx_buffer[1024];
 static uint16_t rx_len = 0;
 static uint16_t rx_pos = 0;
+static uint16_t rx_chunk = 0; /* bytes handed over per bulk read, 0 = no limit */
+static uint16_t tx_write_calls = 0;
+
+/* UART model state (mock_uart_enable()) */
+#define UART_FIFO_MAX 256
+static uint8_t uart_enabled = 0;
+static mock_uart_config_t uart;
+static uint64_t uart_char_ns;          /* line time of one character */
+static uint64_t uart_now;              /* virtual time in nanoseconds */
+static mock_uart_stats_t uart_stats;
+static uint64_t uart_tx_done[UART_FIFO_MAX]; /* when each byte in the transmitter leaves it */
+static uint16_t uart_tx_head;
+static uint16_t uart_tx_count;
+static uint64_t uart_tx_line_free;     /* earliest start of the next transmitted character */
+static uint8_t uart_rx_wire[1024];     /* injected bytes, in line order */
+static uint64_t uart_rx_arrival[1024]; /* when each injected byte has arrived */
+static uint16_t uart_rx_wire_len;
+static uint16_t uart_rx_wire_pos;      /* first byte not yet arrived */
+static uint64_t uart_rx_line_free;     /* earliest start of the next received character */
+static uint8_t uart_rx_fifo[UART_FIFO_MAX];
+static uint16_t uart_rx_fifo_count;
+static uint8_t uart_rx_isr_pending;
+static uint64_t uart_rx_isr_at;        /* when the pending receive interrupt runs */
 
 /**
  * @brief Initialize the mock platform state.
@@ -71,17 +105,48 @@ uint8_t platform_serial_read_byte() {
     return (rx_pos < rx_len) ? rx_buffer[rx_pos++] : 0;
 }
 
+/**
+ * @brief Bulk read from the mock RX buffer.
+ *
+ * Models a UART FIFO that hands over at most `rx_chunk` bytes per call
+ * (see mock_set_rx_chunk()).
+ *
+ * @param buf Destination for the received bytes.
+ * @param max Maximum number of bytes to copy into `buf`.
+ * @return uint16_t Number of bytes copied into `buf`.
+ */
+uint16_t platform_serial_read(uint8_t* buf, uint16_t max) {
+    uint16_t count = (uint16_t)(rx_len - rx_pos);
+    if (count > max) count = max;
+    if ((rx_chunk != 0) && (count > rx_chunk)) count = rx_chunk;
+    memcpy(buf, &rx_buffer[rx_pos], count);
+    rx_pos = (uint16_t)(rx_pos + count);
+    return count;
+}
+
 /**
  * @brief Write a byte to the mock TX buffer.
  *
  * This simulates the platform serial transmit primitive used by the
- * production code. Writes are appended into an in-memory buffer.
+ * production code. Writes are appended into an in-memory buffer and, with the
+ * UART model enabled, scheduled on the line.
  *
  * @param byte The byte to write to the mock TX buffer.
  */
 void platform_serial_write_byte(uint8_t byte) {
     if (tx_len < sizeof(tx_buffer)) tx_buffer[tx_len++] = byte;
-    can_write_state++;
+    if (!uart_enabled) {
+        can_write_state++;
+        return;
+    }
+    uint64_t start = (uart_tx_line_free > uart_now) ? uart_tx_line_free : uart_now;
+    uint64_t done = start + uart_char_ns;
+    uart_tx_line_free = done + uart.gap_ns;
+    uart_tx_done[(uart_tx_head + uart_tx_count) % UART_FIFO_MAX] = done;
+    uart_tx_count++;
+    uart_stats.tx_bytes++;
+    uart_stats.tx_busy_ns += uart_char_ns;
+    uart_stats.tx_done_ns = done;
 }
 
 /**
@@ -90,7 +155,35 @@ void platform_serial_write_byte(uint8_t byte) {
  * @return uint8_t Returns non-zero when writes are currently allowed.
  */
 uint8_t platform_serial_can_write() {
-    return can_write_state < 5;
+    if (!uart_enabled) {
+        return can_write_state < 5;
+    }
+    /* software learns that a byte left the FIFO when the interrupt runs */
+    while ((uart_tx_count != 0) && (uart_tx_done[uart_tx_head] + uart.isr_latency_ns <= uart_now)) {
+        uart_tx_head = (uint16_t)((uart_tx_head + 1) % UART_FIFO_MAX);
+        uart_tx_count--;
+    }
+    return uart_tx_count < uart.tx_fifo;
+}
+
+/**
+ * @brief Bulk write to the mock TX buffer.
+ *
+ * Accepts the same number of bytes a platform_serial_can_write() /
+ * platform_serial_write_byte() loop would, so tests observe identical
+ * partial-write behaviour through either API.
+ *
+ * @param buf Bytes to transmit.
+ * @param len Number of bytes in `buf`.
+ * @return uint16_t Number of bytes accepted.
+ */
+uint16_t platform_serial_write(const uint8_t* buf, uint16_t len) {
+    uint16_t count = 0;
+    tx_write_calls++;
+    while ((count < len) && platform_serial_can_write()) {
+        platform_serial_write_byte(buf[count++]);
+    }
+    return count;
 }
 
 /* Test helpers for mock */
@@ -130,9 +223,19 @@ const uint8_t* mock_tx_buffer(void) {
  */
 void mock_clear_tx(void) {
     tx_len = 0;
+    tx_write_calls = 0;
     memset(tx_buffer, 0, sizeof(tx_buffer));
 }
 
+/**
+ * @brief Return the number of platform_serial_write() calls since mock_clear_tx().
+ *
+ * @return uint16_t Number of bulk write calls.
+ */
+uint16_t mock_tx_write_calls(void) {
+    return tx_write_calls;
+}
+
 /* RX helpers */
 
 /**
@@ -167,3 +270,166 @@ void mock_clear_rx(void) {
 uint16_t mock_rx_len(void) {
     return rx_len;
 }
+
+/**
+ * @brief Return the number of mock RX bytes not yet read by the framer.
+ *
+ * @return uint16_t Number of unread bytes in the mock RX buffer.
+ */
+uint16_t mock_rx_remaining(void) {
+    return (uint16_t)(rx_len - rx_pos);
+}
+
+/**
+ * @brief Limit the number of bytes returned by each platform_serial_read() call.
+ *
+ * @param n Maximum bytes per bulk read; 0 removes the limit.
+ */
+void mock_set_rx_chunk(uint16_t n) {
+    rx_chunk = n;
+}
+
+/**
+ * @brief Milliseconds of virtual time.
+ *
+ * @return uint32_t Virtual time in milliseconds with the UART model enabled, 0 otherwise.
+ */
+uint32_t platform_millis(void) {
+    return uart_enabled ? (uint32_t)(uart_now / 1000000u) : 0;
+}
+
+/* UART model */
+
+/**
+ * @brief Run the receive interrupt: hand the receive FIFO to software.
+ *
+ * Bytes are appended to the mock RX buffer; any that do not fit are counted
+ * as overruns.
+ */
+static void uart_rx_isr(void) {
+    if (rx_pos == rx_len) {
+        rx_pos = rx_len = 0;
+    }
+    for (uint16_t i = 0; i < uart_rx_fifo_count; ++i) {
+        if (rx_len < sizeof(rx_buffer)) {
+            rx_buffer[rx_len++] = uart_rx_fifo[i];
+        } else {
+            uart_stats.rx_overruns++;
+        }
+    }
+    uart_rx_fifo_count = 0;
+    uart_rx_isr_pending = 0;
+}
+
+/**
+ * @brief Apply every receive arrival and interrupt due by the current virtual time.
+ */
+static void uart_rx_catch_up(void) {
+    while ((uart_rx_wire_pos < uart_rx_wire_len) &&
+           (uart_rx_arrival[uart_rx_wire_pos] <= uart_now)) {
+        uint64_t t = uart_rx_arrival[uart_rx_wire_pos];
+        if (uart_rx_isr_pending && (uart_rx_isr_at <= t)) {
+            uart_rx_isr();
+        }
+        if (uart_rx_fifo_count == uart.rx_fifo) {
+            uart_stats.rx_overruns++;
+        } else {
+            uart_rx_fifo[uart_rx_fifo_count++] = uart_rx_wire[uart_rx_wire_pos];
+            if (!uart_rx_isr_pending) {
+                uart_rx_isr_pending = 1;
+                uart_rx_isr_at = t + uart.isr_latency_ns;
+            }
+        }
+        uart_rx_wire_pos++;
+    }
+    if (uart_rx_isr_pending && (uart_rx_isr_at <= uart_now)) {
+        uart_rx_isr();
+    }
+}
+
+/**
+ * @brief Switch the mock to the virtual-time UART model, or back to the in-memory pipe.
+ *
+ * Resets virtual time to 0, the model statistics, and the mock TX and RX buffers.
+ *
+ * @param config Line and controller parameters (FIFO depths are clamped to
+ *               1..256); NULL returns to the in-memory pipe.
+ */
+void mock_uart_enable(const mock_uart_config_t* config) {
+    mock_clear_tx();
+    mock_clear_rx();
+    uart_enabled = (config != NULL);
+    if (!uart_enabled) {
+        return;
+    }
+    uart = *config;
+    if (uart.tx_fifo < 1) uart.tx_fifo = 1;
+    if (uart.tx_fifo > UART_FIFO_MAX) uart.tx_fifo = UART_FIFO_MAX;
+    if (uart.rx_fifo < 1) uart.rx_fifo = 1;
+    if (uart.rx_fifo > UART_FIFO_MAX) uart.rx_fifo = UART_FIFO_MAX;
+    uart_char_ns = ((uint64_t)uart.bits_per_char * 1000000000u + uart.baud / 2) / uart.baud;
+    uart_now = 0;
+    memset(&uart_stats, 0, sizeof(uart_stats));
+    uart_tx_head = uart_tx_count = 0;
+    uart_tx_line_free = 0;
+    uart_rx_wire_len = uart_rx_wire_pos = 0;
+    uart_rx_line_free = 0;
+    uart_rx_fifo_count = 0;
+    uart_rx_isr_pending = 0;
+}
+
+/**
+ * @brief Advance virtual time, delivering the received bytes that become visible meanwhile.
+ *
+ * @param ns Nanoseconds to advance.
+ */
+void mock_uart_advance(uint64_t ns) {
+    uart_now += ns;
+    if (uart_enabled) {
+        uart_rx_catch_up();
+    }
+}
+
+/**
+ * @brief Current virtual time.
+ *
+ * @return uint64_t Nanoseconds since mock_uart_enable().
+ */
+uint64_t mock_uart_now(void) {
+    return uart_now;
+}
+
+/**
+ * @brief Send bytes to the endpoint over the modelled line.
+ *
+ * The first byte starts now, or when the previously injected byte has
+ * finished; each following byte starts one character time plus the gap later.
+ * Bytes beyond the model's 1024-byte line buffer are ignored.
+ *
+ * @param buf Bytes to send.
+ * @param len Number of bytes in `buf`.
+ */
+void mock_uart_rx_inject(const uint8_t* buf, uint16_t len) {
+    if (uart_rx_wire_pos == uart_rx_wire_len) {
+        uart_rx_wire_pos = uart_rx_wire_len = 0;
+    }
+    for (uint16_t i = 0; (i < len) && (uart_rx_wire_len < sizeof(uart_rx_wire)); ++i) {
+        uint64_t start = (uart_rx_line_free > uart_now) ? uart_rx_line_free : uart_now;
+        uint64_t arrival = start + uart_char_ns;
+        uart_rx_line_free = arrival + uart.gap_ns;
+        uart_rx_wire[uart_rx_wire_len] = buf[i];
+        uart_rx_arrival[uart_rx_wire_len++] = arrival;
+        uart_stats.rx_bytes++;
+        uart_stats.rx_busy_ns += uart_char_ns;
+        uart_stats.rx_done_ns = arrival;
+    }
+}
+
+/**
+ * @brief Read the UART model statistics since mock_uart_enable().
+ *
+ * @param stats Filled with the statistics.
+ */
+void mock_uart_get_stats(mock_uart_stats_t* stats) {
+    *stats = uart_stats;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file platform_mock.h
+ * @brief Test controls of the mock platform (platform_mock.c).
+ *
+ * By default the mock is an in-memory byte pipe: received bytes are set up
+ * with mock_set_rx_buffer() and transmit backpressure with
+ * mock_set_can_write().  mock_uart_enable() switches it to a virtual-time
+ * UART model instead, in which bytes take their real line time at a given
+ * baud rate, pass through FIFOs of a given depth, and reach (or are refilled
+ * by) the software only after an interrupt latency.  Virtual time moves only
+ * through mock_uart_advance(), so results are exact and reproducible.
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef PLATFORM_MOCK_H
+#define PLATFORM_MOCK_H
+
+#include <stdint.h>
+
+/* in-memory byte pipe */
+void mock_clear_tx(void);
+void mock_set_can_write(uint8_t v);
+uint16_t mock_tx_len(void);
+const uint8_t* mock_tx_buffer(void);
+void mock_set_rx_buffer(const uint8_t* buf, uint16_t len);
+void mock_clear_rx(void);
+uint16_t mock_rx_len(void);
+uint16_t mock_rx_remaining(void);
+void mock_set_rx_chunk(uint16_t n);
+uint16_t mock_tx_write_calls(void);
+
+/* UART line and controller model */
+typedef struct {
+    uint32_t baud;           /* line rate in bits per second */
+    uint8_t bits_per_char;   /* start + data + parity + stop bits (10 for 8N1) */
+    uint16_t tx_fifo;        /* bytes the transmitter holds, shift register included (>= 1) */
+    uint16_t rx_fifo;        /* bytes the receiver holds until its interrupt runs (>= 1) */
+    uint32_t gap_ns;         /* idle line time after every character, both directions */
+    uint32_t isr_latency_ns; /* delay from a UART event to the interrupt handler servicing it */
+} mock_uart_config_t;
+
+typedef struct {
+    uint32_t tx_bytes;       /* characters sent on the line */
+    uint64_t tx_busy_ns;     /* line time they occupy */
+    uint64_t tx_done_ns;     /* when the last of them has left the line */
+    uint32_t rx_bytes;       /* characters that arrived on the line */
+    uint64_t rx_busy_ns;     /* line time they occupied */
+    uint64_t rx_done_ns;     /* when the last of them had arrived */
+    uint32_t rx_overruns;    /* characters lost to a full receive FIFO */
+} mock_uart_stats_t;
+
+void mock_uart_enable(const mock_uart_config_t* config);
+void mock_uart_advance(uint64_t ns);
+uint64_t mock_uart_now(void);
+void mock_uart_rx_inject(const uint8_t* buf, uint16_t len);
+void mock_uart_get_stats(mock_uart_stats_t* stats);
+
+#endif /* PLATFORM_MOCK_H */
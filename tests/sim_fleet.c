@@ -0,0 +1,331 @@
+/**
+ * @file sim_fleet.c
+ * @brief Host simulation of a large endpoint fleet sharded across worker threads.
+ *
+ * Every endpoint runs in its own mctp_endpoint_t on its own link, a
+ * socketpair or a pty pair, through the Linux backend (src/mctp_linux.c).
+ * The endpoints are dealt round-robin to a fixed pool of worker threads, one
+ * per core and pinned to it.  Each worker owns an epoll loop for its
+ * endpoints' ports and also plays bus owner on the far end of their links,
+ * keeping one Get Endpoint ID request outstanding per endpoint, so a worker's
+ * cost per request covers both sides of the exchange.
+ *
+ * The fleet is run with 1, 2, 4... workers up to the number of online cores
+ * (or the given maximum; workers beyond the core count share cores), each
+ * run for a fixed time.  For each run the benchmark reports the requests
+ * answered per second across all endpoints, the rate per worker, its scaling
+ * efficiency against a single worker, and the requests per CPU second the
+ * workers actually consumed (how well each core is used).
+ *
+ * Usage: sim_fleet [endpoints] [seconds per run] [socketpair|pty] [max workers]
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#define _GNU_SOURCE /* posix_openpt(), ptsname(), pthread_setaffinity_np(), RUSAGE_THREAD */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mctp.h"
+#include "mctp_linux.h"
+#include "fcs.h"
+
+/* epoll events handled per wakeup of a worker */
+#define FLEET_EVENTS 64
+
+/* bus owner end of one endpoint's link */
+struct fleet_link {
+    int fd;             // bus owner side of the link, non-blocking
+    uint8_t flags_seen; // FRAME_CHARs of the response read so far
+};
+
+/* one worker thread and the shard of the fleet it runs */
+struct fleet_worker {
+    pthread_t thread;
+    int cpu;             // core the worker is pinned to
+    int loop_fd;         // epoll loop of the shard's endpoint ports (mctp_linux_poll())
+    int owner_fd;        // epoll set of the bus owner links, plus loop_fd
+    struct fleet_link** links;
+    int nlinks;
+    uint64_t responses;  // responses received while the run was timed
+    double cpu_seconds;  // CPU time the worker consumed
+};
+
+/* Get Endpoint ID request from the bus owner (EID 8) to a not yet assigned endpoint */
+static uint8_t request[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80, 0x02};
+
+static atomic_int stop_run; // set by the main thread when the timed run ends
+
+/**
+ * @brief Send the next request on a link.
+ *
+ * @param link Bus owner end of the link.
+ * @return int 0 on success, -1 when the link did not take the whole request.
+ */
+static int fleet_send_request(struct fleet_link* link) {
+    link->flags_seen = 0;
+    return (write(link->fd, request, sizeof(request)) == (ssize_t)sizeof(request)) ? 0 : -1;
+}
+
+/**
+ * @brief Read what the endpoint sent back and issue a new request per completed response.
+ *
+ * @param link Bus owner end of the link.
+ * @return uint32_t Number of responses completed.
+ */
+static uint32_t fleet_owner_read(struct fleet_link* link) {
+    uint8_t buf[256];
+    uint32_t done = 0;
+    ssize_t n;
+    while ((n = read(link->fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; ++i) {
+            if ((buf[i] == 0x7E) && (++link->flags_seen == 2)) {
+                done++;
+                (void)fleet_send_request(link);
+            }
+        }
+    }
+    return done;
+}
+
+/**
+ * @brief Worker thread: pin to a core, prime every link, and run the shard until stopped.
+ *
+ * @param arg The struct fleet_worker.
+ * @return void* Always NULL.
+ */
+static void* fleet_worker_main(void* arg) {
+    struct fleet_worker* w = (struct fleet_worker*)arg;
+    struct epoll_event events[FLEET_EVENTS];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->cpu, &set);
+    (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    for (int i = 0; i < w->nlinks; ++i) {
+        (void)fleet_send_request(w->links[i]);
+    }
+    uint64_t responses = 0;
+    while (!atomic_load_explicit(&stop_run, memory_order_relaxed)) {
+        int n = epoll_wait(w->owner_fd, events, FLEET_EVENTS, 100);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.ptr == NULL) {
+                (void)mctp_linux_poll(w->loop_fd, 0);
+            } else {
+                responses += fleet_owner_read((struct fleet_link*)events[i].data.ptr);
+            }
+        }
+    }
+    w->responses = responses;
+
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    w->cpu_seconds = (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+                     (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+    return NULL;
+}
+
+/**
+ * @brief Open one link: the endpoint's port and the bus owner's end.
+ *
+ * @param port Endpoint side, set up through the Linux backend.
+ * @param link Bus owner side.
+ * @param use_pty Nonzero for a pty pair (endpoint on the slave), zero for a socketpair.
+ * @return int 0 on success, -1 with errno set.
+ */
+static int fleet_open_link(mctp_linux_port_t* port, struct fleet_link* link, int use_pty) {
+    link->flags_seen = 0;
+    if (use_pty) {
+        int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (master < 0) return -1;
+        if ((grantpt(master) < 0) || (unlockpt(master) < 0) ||
+            (mctp_linux_open(port, ptsname(master), 0) < 0)) {
+            int err = errno;
+            close(master);
+            errno = err;
+            return -1;
+        }
+        link->fd = master;
+        return 0;
+    }
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) < 0) return -1;
+    link->fd = sv[1];
+    return mctp_linux_attach(port, sv[0], 0);
+}
+
+/**
+ * @brief Build a fleet, run it on `nworkers` workers for `seconds`, and report the result.
+ *
+ * All endpoints and their links are set up here, before any worker starts;
+ * each worker then touches only the endpoints of its own shard.
+ *
+ * @param nendpoints Number of endpoints.
+ * @param nworkers Number of worker threads.
+ * @param seconds Length of the timed run.
+ * @param use_pty Nonzero for pty links, zero for socketpairs.
+ * @param base_rate Requests per second of the single-worker run (0 when this is that run).
+ * @return double Requests per second across the fleet, or -1 when the fleet could not be built.
+ */
+static double fleet_run(int nendpoints, int nworkers, double seconds, int use_pty,
+                        double base_rate) {
+    mctp_endpoint_t* eps = calloc((size_t)nendpoints, sizeof(*eps));
+    mctp_linux_port_t* ports = calloc((size_t)nendpoints, sizeof(*ports));
+    struct fleet_link* links = calloc((size_t)nendpoints, sizeof(*links));
+    struct fleet_link** shard_links = calloc((size_t)nendpoints, sizeof(*shard_links));
+    struct fleet_worker* workers = calloc((size_t)nworkers, sizeof(*workers));
+    int ncpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double rate = -1;
+    if (!eps || !ports || !links || !shard_links || !workers) goto out;
+    for (int i = 0; i < nendpoints; ++i) {
+        ports[i].fd = ports[i].epoll_fd = links[i].fd = -1;
+    }
+    for (int w = 0; w < nworkers; ++w) {
+        workers[w].loop_fd = workers[w].owner_fd = -1;
+    }
+
+    for (int w = 0; w < nworkers; ++w) {
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = NULL};
+        workers[w].cpu = w % ncpus;
+        workers[w].loop_fd = mctp_linux_loop_create();
+        workers[w].owner_fd = epoll_create1(EPOLL_CLOEXEC);
+        if ((workers[w].loop_fd < 0) || (workers[w].owner_fd < 0) ||
+            (epoll_ctl(workers[w].owner_fd, EPOLL_CTL_ADD, workers[w].loop_fd, &ev) < 0)) {
+            perror("epoll");
+            goto out;
+        }
+    }
+    /* deal endpoints round-robin; each worker's links are contiguous in shard_links */
+    int next = 0;
+    for (int w = 0; w < nworkers; ++w) {
+        workers[w].links = &shard_links[next];
+        for (int i = w; i < nendpoints; i += nworkers) {
+            if (fleet_open_link(&ports[i], &links[i], use_pty) < 0) {
+                fprintf(stderr, "link %d: %s\n", i, strerror(errno));
+                goto out;
+            }
+            struct epoll_event ev = {.events = EPOLLIN, .data.ptr = &links[i]};
+            if ((mctp_linux_add(workers[w].loop_fd, &ports[i], &eps[i], NULL) < 0) ||
+                (epoll_ctl(workers[w].owner_fd, EPOLL_CTL_ADD, links[i].fd, &ev) < 0)) {
+                perror("epoll_ctl");
+                goto out;
+            }
+            shard_links[next++] = &links[i];
+            workers[w].nlinks++;
+        }
+    }
+
+    struct timespec start, end;
+    atomic_store_explicit(&stop_run, 0, memory_order_relaxed);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int w = 0; w < nworkers; ++w) {
+        pthread_create(&workers[w].thread, NULL, fleet_worker_main, &workers[w]);
+    }
+    struct timespec run = {.tv_sec = (time_t)seconds,
+                           .tv_nsec = (long)((seconds - (double)(time_t)seconds) * 1e9)};
+    nanosleep(&run, NULL);
+    atomic_store_explicit(&stop_run, 1, memory_order_relaxed);
+    uint64_t responses = 0;
+    double cpu_seconds = 0;
+    for (int w = 0; w < nworkers; ++w) {
+        pthread_join(workers[w].thread, NULL);
+        responses += workers[w].responses;
+        cpu_seconds += workers[w].cpu_seconds;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed =
+        (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    rate = (double)responses / elapsed;
+    double per_worker = rate / nworkers;
+    printf("workers %3d  requests/s %10.0f  per worker %9.0f  scaling %5.1f%%  "
+           "per cpu-second %9.0f  cpu busy %5.1f%%\n",
+           nworkers, rate, per_worker, (base_rate > 0) ? 100.0 * per_worker / base_rate : 100.0,
+           (cpu_seconds > 0) ? (double)responses / cpu_seconds : 0.0,
+           100.0 * cpu_seconds / (elapsed * nworkers));
+
+out:
+    for (int i = 0; ports && links && (i < nendpoints); ++i) {
+        mctp_linux_close(&ports[i]);
+        if (links[i].fd >= 0) close(links[i].fd);
+    }
+    for (int w = 0; workers && (w < nworkers); ++w) {
+        if (workers[w].loop_fd >= 0) close(workers[w].loop_fd);
+        if (workers[w].owner_fd >= 0) close(workers[w].owner_fd);
+    }
+    free(workers);
+    free(shard_links);
+    free(links);
+    free(ports);
+    free(eps);
+    return rate;
+}
+
+/**
+ * @brief Simulation entry point.
+ *
+ * @param argc Argument count.
+ * @param argv Optional endpoint count, seconds per run, transport and worker limit.
+ * @return int 0 when every run completed, 1 otherwise.
+ */
+int main(int argc, char** argv) {
+    int nendpoints = (argc > 1) ? atoi(argv[1]) : 1000;
+    double seconds = (argc > 2) ? atof(argv[2]) : 2.0;
+    int use_pty = (argc > 3) && (strcmp(argv[3], "pty") == 0);
+    int ncpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_workers = (argc > 4) ? atoi(argv[4]) : ncpus;
+    if ((nendpoints < 1) || (seconds <= 0) || (max_workers < 1)) {
+        printf("usage: %s [endpoints] [seconds per run] [socketpair|pty] [max workers]\n",
+               argv[0]);
+        return 1;
+    }
+
+    uint16_t fcs = calc_fcs(0xffff, &request[1], 9);
+    request[10] = (uint8_t)(fcs >> 8);
+    request[11] = (uint8_t)(fcs & 0xFF);
+    request[12] = 0x7E;
+
+    printf("fleet of %d endpoints over %s links, %d online cores\n", nendpoints,
+           use_pty ? "pty" : "socketpair", ncpus);
+    double base_rate = 0;
+    for (int nworkers = 1;; nworkers *= 2) {
+        if (nworkers > max_workers) nworkers = max_workers;
+        if (nworkers > nendpoints) break;
+        double rate = fleet_run(nendpoints, nworkers, seconds, use_pty, base_rate);
+        if (rate < 0) return 1;
+        if (nworkers == 1) base_rate = rate;
+        if (nworkers == max_workers) break;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file sim_tx_sched.c
+ * @brief Host simulation of response latency under event load.
+ *
+ * The endpoint core is linked against a simulated UART in which time advances
+ * in byte times: each tick the wire accepts one transmitted byte and delivers
+ * one received byte, and the application runs one iteration of its main loop
+ * (the same loop as examples/main.c).  A bus owner sends Get Endpoint ID
+ * requests, waiting for each response plus a random think time, while the
+ * application offers fixed-size events at a configurable share of the wire
+ * bandwidth.  The latency of every response (last request byte received to
+ * last response byte sent) is reported as percentiles, in byte times.
+ *
+ * The Makefile builds one binary per MCTP_TX_SCHED policy.
+ *
+ * Usage: sim_tx_sched_<policy> [event load %] [event frame bytes] [requests]
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mctp.h"
+#include "mctp_testhooks.h"
+#include "platform.h"
+#include "fcs.h"
+
+#ifndef SIM_POLICY
+#define SIM_POLICY "unknown"
+#endif
+
+/* mean bus owner think time between a response and its next request */
+#define SIM_THINK_TICKS 64
+
+/* a response still missing after this many byte times counts as starved */
+#define SIM_TIMEOUT_TICKS 100000u
+
+/* Get Endpoint ID request from the bus owner (EID 8) to a not yet assigned endpoint */
+static uint8_t request[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80, 0x02};
+
+static const uint8_t* rx_ptr;   // next request byte to deliver
+static uint16_t rx_left;        // request bytes not yet delivered
+static uint8_t rx_credit;       // bytes the line delivers this tick
+static uint8_t tx_credit;       // bytes the line accepts this tick
+
+void platform_init(void) {}
+uint8_t platform_serial_has_data(void) { return (rx_left != 0) && (rx_credit != 0); }
+uint8_t platform_serial_read_byte(void) {
+    rx_credit--;
+    rx_left--;
+    return *rx_ptr++;
+}
+uint16_t platform_serial_read(uint8_t* buf, uint16_t max) {
+    uint16_t n = 0;
+    while ((n < max) && platform_serial_has_data()) buf[n++] = platform_serial_read_byte();
+    return n;
+}
+uint8_t platform_serial_can_write(void) { return tx_credit != 0; }
+void platform_serial_write_byte(uint8_t b) {
+    (void)b;
+    tx_credit--;
+}
+
+/**
+ * @brief Small deterministic PRNG so runs are reproducible across hosts.
+ *
+ * @return uint32_t Next pseudo-random value.
+ */
+static uint32_t sim_rand(void) {
+    static uint32_t state = 0x2545F491u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief Order latencies for qsort().
+ */
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Run the application's main loop once (see examples/main.c).
+ */
+static void app_iteration(void) {
+    mctp_update();
+    if (mctp_is_packet_available()) {
+        if (mctp_is_control_packet()) {
+            mctp_process_control_message();
+        } else {
+            mctp_ignore_packet();
+        }
+    }
+}
+
+/**
+ * @brief Simulation entry point.
+ *
+ * @param argc Argument count.
+ * @param argv Optional event load (% of wire bandwidth), event frame length and request count.
+ * @return int 0 when every response was sent, 1 when responses starved.
+ */
+int main(int argc, char** argv) {
+    int load_pct = (argc > 1) ? atoi(argv[1]) : 70;
+    int event_len = (argc > 2) ? atoi(argv[2]) : 32;
+    int requests = (argc > 3) ? atoi(argv[3]) : 20000;
+    if ((event_len < 11) || (event_len > MCTP_EVENT_TX_BUF_SIZE) || (requests < 1)) {
+        printf("event length must be 11..%d bytes\n", MCTP_EVENT_TX_BUF_SIZE);
+        return 1;
+    }
+
+    uint16_t fcs = calc_fcs(0xffff, &request[1], 9);
+    request[10] = (uint8_t)(fcs >> 8);
+    request[11] = (uint8_t)(fcs & 0xFF);
+    request[12] = 0x7E;
+
+    /* events carry no bytes that need escaping, so wire length == frame length */
+    uint8_t event[MCTP_EVENT_TX_BUF_SIZE];
+    memset(event, 0x11, sizeof(event));
+    event[0] = 0x7E;
+    event[1] = 0x01;
+    event[2] = (uint8_t)(event_len - 6);
+    event[event_len - 1] = 0x7E;
+
+    uint32_t* latency = malloc(sizeof(uint32_t) * (size_t)requests);
+    if (latency == NULL) return 1;
+    mctp_init();
+
+    uint64_t tick = 0;
+    uint64_t events_queued = 0;
+    uint64_t events_refused = 0;
+    uint64_t next_request = 0;
+    uint64_t request_done = 0; // tick the last request byte was delivered
+    int done = 0;
+    int in_flight = 0; // 0 idle, 1 request on the line, 2 awaiting the response
+    int starved = 0;
+    while (done < requests) {
+        tick++;
+        rx_credit = 1;
+        tx_credit = 1;
+
+        /* events arrive so that they occupy load_pct of the wire on average */
+        if ((int)(sim_rand() % (100u * (uint32_t)event_len)) < load_pct) {
+            if (mctp_send_event(event, (uint16_t)event_len) == 0) {
+                events_queued++;
+            } else {
+                events_refused++;
+            }
+        }
+
+        if ((in_flight == 0) && (tick >= next_request)) {
+            rx_ptr = request;
+            rx_left = sizeof(request);
+            in_flight = 1;
+        }
+
+        app_iteration();
+
+        if ((in_flight == 1) && (rx_left == 0)) {
+            request_done = tick;
+            in_flight = 2;
+        }
+        if ((in_flight == 2) && (rxState == MCTPSER_WAITING_FOR_SYNC)) {
+            latency[done++] = (uint32_t)(tick - request_done);
+            in_flight = 0;
+            next_request = tick + sim_rand() % (2 * SIM_THINK_TICKS);
+        } else if ((in_flight == 2) && (tick - request_done > SIM_TIMEOUT_TICKS)) {
+            starved = 1;
+            break;
+        }
+    }
+
+    printf("%-11s load %3d%% event %3dB", SIM_POLICY, load_pct, event_len);
+    if (done == 0) {
+        printf("  responses starved\n");
+        free(latency);
+        return 1;
+    }
+    qsort(latency, (size_t)done, sizeof(uint32_t), cmp_u32);
+    printf("  p50 %6u  p90 %6u  p99 %6u  max %6u  events %llu queued %llu refused%s\n",
+           latency[done / 2], latency[done * 9 / 10], latency[done * 99 / 100], latency[done - 1],
+           (unsigned long long)events_queued, (unsigned long long)events_refused,
+           starved ? "  (responses starved)" : "");
+    free(latency);
+    return starved;
+}
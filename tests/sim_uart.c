@@ -0,0 +1,146 @@
+/**
+ * @file sim_uart.c
+ * @brief Request-to-response latency and line utilization across UART configurations.
+ *
+ * The endpoint core runs against the virtual-time UART model of
+ * platform_mock.c, with the main loop of examples/main.c executed once per
+ * loop period of virtual time.  For each combination of baud rate, transmit
+ * FIFO depth and interrupt latency a bus owner sends Get Endpoint ID requests
+ * back to back (each after the previous response), and the table reports the
+ * latency from the last request byte on the line to the last response byte
+ * on the line, the share of that time the transmit line was busy, and the
+ * receive FIFO overruns.
+ *
+ * Usage: sim_uart [loop period ns] [requests]
+ *
+ * @author Douglas Sandy
+ *
+ * MIT No Attribution
+ *
+ * Copyright (c) 2025 Doug
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mctp.h"
+#include "platform_mock.h"
+#include "fcs.h"
+
+/* a response missing this long after its request counts as lost */
+#define SIM_TIMEOUT_NS 50000000u
+
+/* Get Endpoint ID request from the bus owner (EID 8) to a not yet assigned endpoint */
+static uint8_t request[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80, 0x02};
+
+/**
+ * @brief Run one line configuration and print its row.
+ *
+ * @param config UART model parameters.
+ * @param loop_ns Virtual time per main loop iteration.
+ * @param requests Number of requests to send.
+ */
+static void sim_config(const mock_uart_config_t* config, uint64_t loop_ns, int requests) {
+    mock_uart_stats_t st;
+    uint64_t latency_sum = 0;
+    uint64_t latency_max = 0;
+    uint64_t busy_sum = 0;
+    int answered = 0;
+
+    mctp_init();
+    mock_uart_enable(config);
+    for (int r = 0; r < requests; ++r) {
+        mock_uart_get_stats(&st);
+        uint32_t tx_before = st.tx_bytes;
+        uint64_t busy_before = st.tx_busy_ns;
+        mock_uart_rx_inject(request, sizeof(request));
+        mock_uart_get_stats(&st);
+        uint64_t request_done = st.rx_done_ns;
+        /* run until the response has left the line (or is given up on) */
+        for (;;) {
+            mctp_update();
+            if (mctp_is_packet_available()) {
+                mctp_process_control_message();
+            }
+            mock_uart_advance(loop_ns);
+            mock_uart_get_stats(&st);
+            if ((st.tx_bytes > tx_before) && (mock_uart_now() >= st.tx_done_ns) &&
+                (mock_tx_len() >= 3) && (mock_tx_buffer()[mock_tx_len() - 1] == 0x7E)) {
+                break;
+            }
+            if (mock_uart_now() > request_done + SIM_TIMEOUT_NS) {
+                break;
+            }
+        }
+        if (st.tx_bytes > tx_before) {
+            uint64_t latency = st.tx_done_ns - request_done;
+            latency_sum += latency;
+            if (latency > latency_max) latency_max = latency;
+            busy_sum += st.tx_busy_ns - busy_before;
+            answered++;
+        }
+        mock_clear_tx();
+    }
+    mock_uart_get_stats(&st);
+    mock_uart_enable(NULL);
+
+    printf("%8u baud  tx fifo %3u  isr %6u ns  ", config->baud, config->tx_fifo,
+           config->isr_latency_ns);
+    if (answered == 0) {
+        printf("no responses  overruns %u\n", st.rx_overruns);
+        return;
+    }
+    printf("latency mean %8.1f us  max %8.1f us  tx busy %5.1f%%  answered %d/%d  overruns %u\n",
+           (double)latency_sum / answered / 1000.0, (double)latency_max / 1000.0,
+           100.0 * (double)busy_sum / (double)latency_sum, answered, requests, st.rx_overruns);
+}
+
+/**
+ * @brief Simulation entry point.
+ *
+ * @param argc Argument count.
+ * @param argv Optional loop period in nanoseconds and request count.
+ * @return int 0.
+ */
+int main(int argc, char** argv) {
+    uint64_t loop_ns = (argc > 1) ? (uint64_t)atoll(argv[1]) : 10000;
+    int requests = (argc > 2) ? atoi(argv[2]) : 100;
+    static const uint32_t bauds[] = {115200, 1000000, 3000000};
+    static const uint16_t tx_fifos[] = {1, 16};
+    static const uint32_t isr_latencies[] = {2000, 50000};
+
+    uint16_t fcs = calc_fcs(0xffff, &request[1], 9);
+    request[10] = (uint8_t)(fcs >> 8);
+    request[11] = (uint8_t)(fcs & 0xFF);
+    request[12] = 0x7E;
+
+    printf("Get Endpoint ID over a modelled UART, main loop every %llu ns, rx fifo 16\n",
+           (unsigned long long)loop_ns);
+    for (size_t b = 0; b < sizeof(bauds) / sizeof(bauds[0]); ++b) {
+        for (size_t f = 0; f < sizeof(tx_fifos) / sizeof(tx_fifos[0]); ++f) {
+            for (size_t i = 0; i < sizeof(isr_latencies) / sizeof(isr_latencies[0]); ++i) {
+                mock_uart_config_t config = {.baud = bauds[b], .bits_per_char = 10,
+                                             .tx_fifo = tx_fifos[f], .rx_fifo = 16,
+                                             .gap_ns = 0, .isr_latency_ns = isr_latencies[i]};
+                sim_config(&config, loop_ns, requests);
+            }
+        }
+    }
+    return 0;
+}
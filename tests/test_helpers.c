@@ -31,14 +31,11 @@
 #include <stdint.h>
 #include "../include/mctp.h"
 
-/* For test-only access to internal mctp state, the variables are non-static when
- * compiled with UNIT_TEST. Declare them here as extern so tests can set up the
- * transmit buffer without embedding helpers in production code.
+/* For test-only access to internal mctp state, mctp_testhooks.h names the
+ * members of the default endpoint, so tests can set up the transmit buffer
+ * without embedding helpers in production code.
  */
-extern uint8_t mctp_buffer[];
-extern uint8_t byte_count;
-extern uint8_t buffer_idx;
-extern uint8_t rxState;
+#include "mctp_testhooks.h"
 
 /**
  * @brief Test helper to populate the internal `mctp` buffer with a frame.
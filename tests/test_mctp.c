@@ -27,15 +27,35 @@
  * SOFTWARE.
  */
 
+#define _GNU_SOURCE /* posix_openpt(), ptsname() */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdarg.h>
 
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 #include "../include/mctp.h"
 #include "../src/fcs.h"
+#include "../include/mctp_ring.h"
+#include "../include/mctp_reasm.h"
+#if !MCTP_RX_RING_ENABLED
+#include "../include/mctp_linux.h"
+#endif
 #include "mctp_testhooks.h"
+#include "platform_mock.h"
+#include "platform.h"
 
 /* test-side constants used by the tests */
 #ifndef FRAME_CHAR
@@ -48,17 +68,44 @@
 #define MCTP_BUFFER_SIZE (64 + 6)
 #endif
 
-/* forward-declare mock helpers from platform_mock.c */
-void mock_clear_tx(void);
-void mock_set_can_write(uint8_t v);
-uint16_t mock_tx_len(void);
-const uint8_t* mock_tx_buffer(void);
-extern uint8_t mctp_send_frame(void);
-void mock_set_rx_buffer(const uint8_t* buf, uint16_t len);
-void mock_clear_rx(void);
-uint16_t mock_rx_len(void);
 extern uint8_t platform_serial_has_data(void);
 
+#if MCTP_RX_RING_ENABLED
+/* With the receive ring the core never reads the platform, so the tests play
+ * the UART interrupt: before each update, once the ring is empty, the chunk
+ * the core would have read from the mock platform is moved into the ring.
+ * Bytes the core leaves unread thus stay in the mock, as without the ring. */
+static void test_ring_isr_update(void) {
+    uint8_t chunk[MCTP_RX_CHUNK_SIZE];
+    if (mctp_ring_count(&mctp_rx_ring) == 0) {
+        (void)mctp_ring_write(&mctp_rx_ring, chunk, platform_serial_read(chunk, sizeof(chunk)));
+    }
+    mctp_update();
+}
+#define mctp_update() test_ring_isr_update()
+#endif
+
+/* Vendor control command added at link time (see test_control_dispatch_table()) */
+#define TEST_VENDOR_COMMAND 0x1A
+static int vendor_command_calls;
+static void vendor_command_handler(mctp_endpoint_t* ep) {
+    uint16_t len = 0;
+    uint8_t* msg = mctp_get_request_ctx(ep, &len);
+    vendor_command_calls++;
+    if ((msg == NULL) || (len < 3)) {
+        mctp_ignore_packet_ctx(ep);
+        return;
+    }
+    msg[1] &= 0x7F;                         /* clear Rq */
+    msg[3] = CONTROL_COMPLETE_SUCCESS;
+    msg[4] = (uint8_t)(len + 0x40);         /* echo the request length */
+    (void)mctp_send_response_ctx(ep, 5);
+}
+const mctp_control_handler_t mctp_control_handlers[MCTP_CONTROL_COMMANDS] = {
+    MCTP_CONTROL_STANDARD_HANDLERS,
+    [TEST_VENDOR_COMMAND] = vendor_command_handler,
+};
+
 /* Test runner bookkeeping */
 static char last_failure_msg[512];
 static const char* last_failure_file = NULL;
@@ -125,6 +172,21 @@ static int require_u8_array_eq(const uint8_t* expected, const uint8_t* actual, s
 }
 
 
+/**
+ * @brief Return a cycle count (x86) or nanosecond timestamp used for latency reports.
+ *
+ * @return uint64_t Current cycle counter or monotonic time in nanoseconds.
+ */
+static uint64_t test_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
 /**
  * @brief Unescape a transmitted buffer into its logical form.
  *
@@ -190,7 +252,7 @@ int test_send_frame_escape_and_resume(void) {
             uint8_t body = (uint8_t)((_len >= 6) ? (_len - 6) : 0);
             mctp_buffer[2] = body;
         }
-        buffer_idx = (uint8_t)_len;
+        buffer_idx = _len;
         rxState = MCTPSER_AWAITING_RESPONSE;
     }
     mock_set_can_write(1);
@@ -232,7 +294,7 @@ int test_send_frame_reentrancy(void) {
             uint8_t body = (uint8_t)((_len >= 6) ? (_len - 6) : 0);
             mctp_buffer[2] = body;
         }
-        buffer_idx = (uint8_t)_len;
+        buffer_idx = _len;
         rxState = MCTPSER_AWAITING_RESPONSE;
     }
     mock_set_can_write(4);
@@ -250,6 +312,54 @@ int test_send_frame_reentrancy(void) {
     return 0;
 }
 
+/**
+ * @brief Test that the sender writes clean runs in bulk and escapes correctly.
+ *
+ * A 40-byte body with one FRAME_CHAR and one ESCAPE_CHAR is sent through a
+ * mock that accepts five bytes per window.  The wire image must match the
+ * escaped frame and most windows must be filled by a single write call.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_send_frame_bulk_runs(void) {
+    const uint8_t body = 40;
+    uint8_t expected[2 * MCTP_BUFFER_SIZE];
+    uint16_t en = 0;
+    mctp_buffer[0] = FRAME_CHAR; mctp_buffer[1] = 0x01; mctp_buffer[2] = body;
+    for (uint8_t k = 0; k < body; ++k) mctp_buffer[3 + k] = (uint8_t)(0x20 + k);
+    mctp_buffer[3 + 10] = FRAME_CHAR;
+    mctp_buffer[3 + 25] = ESCAPE_CHAR;
+    mctp_buffer[3 + body] = 0x11; mctp_buffer[4 + body] = 0x22; mctp_buffer[5 + body] = FRAME_CHAR;
+    for (uint16_t k = 0; k < (uint16_t)(body + 6); ++k) {
+        uint8_t b = mctp_buffer[k];
+        if ((k >= 3) && (k < (uint16_t)(body + 3)) && ((b == FRAME_CHAR) || (b == ESCAPE_CHAR))) {
+            expected[en++] = ESCAPE_CHAR;
+            b = (uint8_t)(b - 0x20);
+        }
+        expected[en++] = b;
+    }
+    buffer_idx = (uint16_t)(body + 6);
+    rxState = MCTPSER_AWAITING_RESPONSE;
+
+    mock_clear_tx();
+    int windows = 0;
+    do {
+        mock_set_can_write(0);
+        mctp_send_frame();
+        ++windows;
+    } while ((mock_tx_len() < en) && (windows < 100));
+    if (require(mock_tx_len() == en, "wire length %u, expected %u", mock_tx_len(), en)) return 1;
+    if (require_u8_array_eq(expected, mock_tx_buffer(), en)) return 1;
+    if (require(mock_tx_write_calls() < en / 2, "%u write calls for %u bytes",
+                mock_tx_write_calls(), en)) return 1;
+#if MCTP_TX_STAGING_ENABLED
+    /* the staged image needs no escape pairs split across calls: one write per window */
+    if (require(mock_tx_write_calls() <= windows, "%u write calls in %d windows",
+                mock_tx_write_calls(), windows)) return 1;
+#endif
+    return 0;
+}
+
 /**
  * @brief Test that a valid RX frame results in a packet being available.
  *
@@ -267,13 +377,306 @@ int test_validate_rx_valid(void) {
     frame[10] = 0x7E;
     mock_clear_rx();
     mock_set_rx_buffer(frame, total_len);
-    extern void mctp_update(void);
     int iter = 0;
     while (!mctp_is_packet_available() && iter++ < 20) mctp_update();
     if (require(mctp_is_packet_available(), "expected packet available")) return 1;
     return 0;
 }
 
+/**
+ * @brief Test that mctp_update() consumes a whole bulk-read chunk per call.
+ *
+ * A frame preceded by line noise and followed by the start of another frame
+ * is handed over in one chunk: the packet must be available after a single
+ * call and the trailing bytes dropped.  The same stream split into 3-byte
+ * chunks must complete in one call per chunk.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_bulk_chunk(void) {
+    uint8_t stream[16];
+    int n = 0;
+    stream[n++] = 0x55; stream[n++] = 0xAA;
+    stream[n++] = FRAME_CHAR; stream[n++] = 0x01; stream[n++] = 5;
+    stream[n++] = 0x10; stream[n++] = 0x00; stream[n++] = 0x30; stream[n++] = 0x40;
+    stream[n++] = 0x50;
+    uint16_t fcs = calc_fcs(0xffff, &stream[3], 7);
+    stream[n++] = (uint8_t)(fcs >> 8); stream[n++] = (uint8_t)(fcs & 0xFF);
+    stream[n++] = FRAME_CHAR;
+    stream[n++] = FRAME_CHAR; stream[n++] = 0x01;
+
+    mctp_init();
+    mock_clear_rx(); mock_set_rx_buffer(stream, (uint16_t)n);
+    mctp_update();
+    if (require(mctp_is_packet_available(), "expected packet after one bulk call")) return 1;
+    if (require(mctp_buffer[7] == 0x50, "unexpected message type 0x%02x",
+                mctp_buffer[7])) return 1;
+    mctp_update();
+    if (require(mock_rx_remaining() == 0, "trailing bytes not drained")) return 1;
+    mctp_ignore_packet();
+
+    mctp_init();
+    mock_clear_rx(); mock_set_rx_buffer(stream, 14);
+    mock_set_rx_chunk(3);
+    int calls = 0;
+    while (!mctp_is_packet_available() && calls < 20) {
+        mctp_update();
+        ++calls;
+    }
+    mock_set_rx_chunk(0);
+    if (require(mctp_is_packet_available(), "expected packet with 3-byte chunks")) return 1;
+    if (require(calls == 5, "expected 5 calls with 3-byte chunks, got %d", calls)) return 1;
+    mctp_ignore_packet();
+    return 0;
+}
+
+/**
+ * @brief Test that line noise ahead of a frame is skipped and counted.
+ *
+ * Noise (including, when the transmission unit leaves room for it, a stray
+ * FRAME_CHAR whose "frame" is dropped for an oversized length) precedes a
+ * valid frame; the frame must still be received and every skipped byte
+ * counted.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_sync_hunt(void) {
+    uint8_t stream[64];
+    int n = 0;
+    for (int k = 0; k < 30; ++k) stream[n++] = (uint8_t)(0x40 + k);
+#if MCTP_TRANSMISSION_UNIT < 255
+    /* dropped: too long */
+    stream[n++] = FRAME_CHAR; stream[n++] = 0x01; stream[n++] = MCTP_TRANSMISSION_UNIT + 1;
+#endif
+    for (int k = 0; k < 10; ++k) stream[n++] = 0x11;
+    int frame_start = n;
+    stream[n++] = FRAME_CHAR; stream[n++] = 0x01; stream[n++] = 5;
+    stream[n++] = 0x10; stream[n++] = 0x00; stream[n++] = 0x30; stream[n++] = 0x40;
+    stream[n++] = 0x50;
+    uint16_t fcs = calc_fcs(0xffff, &stream[frame_start + 1], 7);
+    stream[n++] = (uint8_t)(fcs >> 8); stream[n++] = (uint8_t)(fcs & 0xFF);
+    stream[n++] = FRAME_CHAR;
+
+    mctp_init();
+    mock_clear_rx(); mock_set_rx_buffer(stream, (uint16_t)n);
+    int calls = 0;
+    while (!mctp_is_packet_available() && calls < 20) {
+        mctp_update();
+        ++calls;
+    }
+    if (require(mctp_is_packet_available(), "frame after noise not received")) return 1;
+    if (require(mctp_get_sync_discards() == 40, "expected 40 discarded bytes, got %u",
+                (unsigned)mctp_get_sync_discards())) return 1;
+    mctp_ignore_packet();
+    return 0;
+}
+
+/**
+ * @brief Differential test of the bulk body copy against the per-byte state machine.
+ *
+ * Random streams of noise and frames whose bodies are dense in FRAME_CHAR and
+ * ESCAPE_CHAR (properly escaped, with occasional corrupted escapes, bad FCS
+ * or truncation) are fed once byte by byte through mctp_rx_byte() and once
+ * through mctp_update() with random chunk sizes.  Framer state, buffer index
+ * and buffer contents must match.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_bulk_unescape_differential(void) {
+    static const uint8_t alphabet[] = {FRAME_CHAR, ESCAPE_CHAR, 0x5E, 0x5D, 0x00, 0x42};
+    int accepted = 0;
+    srand(8);
+    for (int iter = 0; iter < 2000; ++iter) {
+        uint8_t body[MCTP_BUFFER_SIZE];
+        uint8_t wire[512];
+        int wn = 0;
+        int noise = rand() % 8;
+        for (int k = 0; k < noise; ++k) wire[wn++] = (uint8_t)rand();
+        uint8_t count = (uint8_t)(1 + rand() % (MCTP_BUFFER_SIZE - 6));
+        body[0] = 0x01; body[1] = count;
+        for (int k = 0; k < count; ++k) {
+            body[2 + k] = (rand() & 1) ? alphabet[rand() % sizeof(alphabet)] : (uint8_t)rand();
+        }
+        if (count > 1) body[3] = 0xFF; /* broadcast destination so good frames are accepted */
+#if MCTP_REASSEMBLY_ENABLED
+        /* single-packet messages, so that no good frame is absorbed by reassembly */
+        if (count > 3) body[5] |= MCTP_FLAG_SOM | MCTP_FLAG_EOM;
+#endif
+        uint16_t fcs = calc_fcs(0xffff, body, count + 2);
+        if (rand() % 8 == 0) fcs ^= 0x0100;
+        wire[wn++] = FRAME_CHAR; wire[wn++] = body[0]; wire[wn++] = body[1];
+        for (int k = 0; k < count; ++k) {
+            uint8_t b = body[2 + k];
+            if ((b == FRAME_CHAR) || (b == ESCAPE_CHAR)) {
+                wire[wn++] = ESCAPE_CHAR;
+                b = (uint8_t)(b - 0x20);
+                if (rand() % 64 == 0) b = 0x33; /* invalid escape */
+            }
+            wire[wn++] = b;
+        }
+        wire[wn++] = (uint8_t)(fcs >> 8); wire[wn++] = (uint8_t)(fcs & 0xFF);
+        wire[wn++] = FRAME_CHAR;
+        if (rand() % 8 == 0) wn -= 1 + rand() % (wn / 2);
+
+        /* reference: one byte at a time, stopping once a frame is held */
+        uint8_t ref_buf[MCTP_BUFFER_SIZE];
+        mctp_init();
+        for (int k = 0; (k < wn) && !mctp_is_packet_available(); ++k) mctp_rx_byte(&mctp_default_endpoint, wire[k]);
+        uint8_t ref_state = rxState;
+        uint16_t ref_idx = buffer_idx;
+        accepted += (ref_state == MCTPSER_AWAITING_RESPONSE);
+        memcpy(ref_buf, mctp_buffer, ref_idx);
+
+        mctp_init();
+        mock_clear_rx(); mock_set_rx_buffer(wire, (uint16_t)wn);
+        mock_set_rx_chunk((uint16_t)(1 + rand() % 40));
+        while (!mctp_is_packet_available() && mock_rx_remaining() != 0) mctp_update();
+        mock_set_rx_chunk(0);
+
+        if (require(rxState == ref_state, "iter %d: state %u != reference %u", iter, rxState,
+                    ref_state)) return 1;
+        if (require(buffer_idx == ref_idx, "iter %d: index %u != reference %u", iter,
+                    buffer_idx, ref_idx)) return 1;
+        if (require_u8_array_eq(ref_buf, mctp_buffer, ref_idx)) return 1;
+        mctp_ignore_packet();
+    }
+    if (require(accepted > 500, "only %d frames accepted", accepted)) return 1;
+    return 0;
+}
+
+/**
+ * @brief Test that the bulk body copy stays inside the receive buffer.
+ *
+ * The framer is put in the body state with a byte count far larger than the
+ * buffer, as a corrupt length byte that got past the header checks would
+ * leave it.  Clean bytes then arrive through mctp_update() in large chunks;
+ * the bulk copy must not write past the buffer, and a valid frame following
+ * must be received.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_bulk_bad_length(void) {
+    uint8_t stream[2 * MCTP_BUFFER_SIZE + 13];
+    int n = 0;
+    for (int k = 0; k < 2 * MCTP_BUFFER_SIZE; ++k) stream[n++] = (uint8_t)(0x20 + (k & 0x3F));
+    int frame_start = n;
+    stream[n++] = FRAME_CHAR; stream[n++] = 0x01; stream[n++] = 0x07; stream[n++] = 0x01;
+    stream[n++] = 0x00; stream[n++] = 0x08; stream[n++] = 0xC8; stream[n++] = 0x00;
+    stream[n++] = 0x80; stream[n++] = CONTROL_MSG_GET_ENDPOINT_ID;
+    uint16_t fcs = calc_fcs(0xffff, &stream[frame_start + 1], 9);
+    stream[n++] = (uint8_t)(fcs >> 8); stream[n++] = (uint8_t)(fcs & 0xFF);
+    stream[n++] = FRAME_CHAR;
+
+    static const uint8_t byte_counts[] = {0xFF, 0x80};
+    for (size_t b = 0; b < sizeof(byte_counts); ++b) {
+        uint8_t byte_count = byte_counts[b];
+        mctp_init();
+        const uint8_t header[3] = {FRAME_CHAR, 0x01, 0x05};
+        for (int k = 0; k < 3; ++k) mctp_rx_byte(&mctp_default_endpoint, header[k]);
+        if (require(rxFramerState == MCTPSER_BODY, "header not accepted")) return 1;
+        mctp_default_endpoint.byte_count = byte_count;
+        mock_clear_rx(); mock_set_rx_buffer(stream, (uint16_t)n);
+        mock_set_rx_chunk(64);
+        for (int it = 0; (it < 100) && !mctp_is_packet_available(); ++it) {
+            mctp_update();
+            if (require(rxFramerIdx <= MCTP_BUFFER_SIZE - 3, "index %u past the body room",
+                        (unsigned)rxFramerIdx)) {
+                mock_set_rx_chunk(0);
+                return 1;
+            }
+        }
+        mock_set_rx_chunk(0);
+        if (require(mctp_is_packet_available(), "no resync after byte count %u", byte_count)) {
+            return 1;
+        }
+        if (require(mctp_buffer[9] == CONTROL_MSG_GET_ENDPOINT_ID, "wrong frame received")) return 1;
+        mctp_ignore_packet();
+    }
+    return 0;
+}
+
+/**
+ * @brief Measure end-of-frame to packet-available latency.
+ *
+ * Feeds a maximum-size frame and checks that the packet is available as soon
+ * as the call that consumes the closing FRAME_CHAR returns (no additional
+ * mctp_update() calls).  The cost of that final call is reported next to the
+ * average cost of a body byte; with the FCS accumulated during reception the
+ * two are of the same order rather than proportional to the frame length.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_eof_latency(void) {
+    mctp_init();
+    const int byte_count = MCTP_TRANSMISSION_UNIT;
+    uint8_t frame[MCTP_BUFFER_SIZE];
+    int i = 0;
+    frame[i++] = FRAME_CHAR; frame[i++] = 0x01; frame[i++] = (uint8_t)byte_count;
+    frame[i++] = 0x01; frame[i++] = 0x00; frame[i++] = 0x08; frame[i++] = 0xC8;
+    for (int k = 4; k < byte_count; ++k) frame[i++] = (uint8_t)(k & 0x3F);
+    uint16_t fcs = calc_fcs(0xffff, &frame[1], byte_count + 2);
+    frame[i++] = (uint8_t)(fcs >> 8); frame[i++] = (uint8_t)(fcs & 0xFF); frame[i++] = FRAME_CHAR;
+    mock_clear_rx(); mock_set_rx_buffer(frame, (uint16_t)i);
+    mock_set_rx_chunk(1);
+
+    uint64_t body_cycles = 0;
+    int calls = 0;
+    while (platform_serial_has_data() && mock_rx_remaining() > 1) {
+        uint64_t t0 = test_cycles();
+        mctp_update();
+        body_cycles += test_cycles() - t0;
+        ++calls;
+    }
+    uint64_t t0 = test_cycles();
+    mctp_update();
+    uint64_t eof_cycles = test_cycles() - t0;
+    int extra_calls = 0;
+    while (!mctp_is_packet_available() && extra_calls < 100) {
+        mctp_update();
+        ++extra_calls;
+    }
+    printf("    eof->available: %d extra calls, final call %llu, average byte call %llu (cycles)\n",
+           extra_calls, (unsigned long long)eof_cycles,
+           (unsigned long long)(calls ? body_cycles / (uint64_t)calls : 0));
+    mock_set_rx_chunk(0);
+    if (require(extra_calls == 0, "packet became available %d calls after EOF", extra_calls)) return 1;
+    mctp_ignore_packet();
+    return 0;
+}
+
+/**
+ * @brief Test the receive length limit at the transmission unit.
+ *
+ * A packet whose byte count equals MCTP_TRANSMISSION_UNIT fills the buffer
+ * exactly and must be accepted; one byte more must be dropped (unless the
+ * unit is already the largest byte count the field can carry).
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_transmission_unit_boundary(void) {
+    uint8_t frame[MCTP_BUFFER_SIZE + 1];
+    for (int byte_count = MCTP_TRANSMISSION_UNIT;
+         (byte_count <= MCTP_TRANSMISSION_UNIT + 1) && (byte_count <= 255); ++byte_count) {
+        int i = 0;
+        frame[i++] = FRAME_CHAR; frame[i++] = 0x01; frame[i++] = (uint8_t)byte_count;
+        frame[i++] = 0x01; frame[i++] = 0x00; frame[i++] = 0x08; frame[i++] = 0xC8;
+        for (int k = 4; k < byte_count; ++k) frame[i++] = (uint8_t)(k & 0x3F);
+        uint16_t fcs = calc_fcs(0xffff, &frame[1], byte_count + 2);
+        frame[i++] = (uint8_t)(fcs >> 8); frame[i++] = (uint8_t)(fcs & 0xFF); frame[i++] = FRAME_CHAR;
+        mctp_init();
+        mock_clear_rx(); mock_set_rx_buffer(frame, (uint16_t)i);
+        int iter = 0; while (!mctp_is_packet_available() && iter++ < 100) mctp_update();
+        int accepted = mctp_is_packet_available();
+        if (accepted) mctp_ignore_packet();
+        if (byte_count == MCTP_TRANSMISSION_UNIT) {
+            if (require(accepted, "byte count %d (the unit) rejected", byte_count)) return 1;
+        } else if (require(!accepted, "byte count %d (over the unit) accepted", byte_count)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Test that a frame with bad FCS is rejected.
  *
@@ -286,7 +689,6 @@ int test_validate_rx_bad_fcs(void) {
     uint16_t fcs = calc_fcs(0xffff, &frame[1], 7); fcs ^= 0x1234;
     frame[8] = (uint8_t)(fcs >> 8); frame[9] = (uint8_t)(fcs & 0x00FF); frame[10] = 0x7E;
     mock_clear_rx(); mock_set_rx_buffer(frame, total_len);
-    extern void mctp_update(void);
     int iter = 0; while (!mctp_is_packet_available() && iter++ < 20) mctp_update();
     if (require(!mctp_is_packet_available(), "expected no packet available")) return 1;
     return 0;
@@ -331,7 +733,7 @@ int test_init_and_helpers(void) {
         uint16_t _len = 11; if (_len > MCTP_BUFFER_SIZE) _len = MCTP_BUFFER_SIZE;
         for (uint16_t _i = 0; _i < _len; ++_i) mctp_buffer[_i] = frame[_i];
         if (_len > 2) mctp_buffer[2] = (uint8_t)((_len >= 6) ? (_len - 6) : 0);
-        buffer_idx = (uint8_t)_len; rxState = MCTPSER_AWAITING_RESPONSE;
+        buffer_idx = _len; rxState = MCTPSER_AWAITING_RESPONSE;
     }
     if (require(mctp_is_control_packet(), "expected control packet")) return 1;
     frame[7] = 0x01;
@@ -339,7 +741,7 @@ int test_init_and_helpers(void) {
         uint16_t _len = 11; if (_len > MCTP_BUFFER_SIZE) _len = MCTP_BUFFER_SIZE;
         for (uint16_t _i = 0; _i < _len; ++_i) mctp_buffer[_i] = frame[_i];
         if (_len > 2) mctp_buffer[2] = (uint8_t)((_len >= 6) ? (_len - 6) : 0);
-        buffer_idx = (uint8_t)_len; rxState = MCTPSER_AWAITING_RESPONSE;
+        buffer_idx = _len; rxState = MCTPSER_AWAITING_RESPONSE;
     }
     if (require(mctp_is_pldm_packet(), "expected PLDM packet")) return 1;
     mctp_ignore_packet();
@@ -554,6 +956,56 @@ int test_control_unsupported_command(void) {
     return 0;
 }
 
+/**
+ * @brief Test dispatch of a control command added through the handler table.
+ *
+ * The test binary defines `mctp_control_handlers` with one vendor command on
+ * top of the standard ones.  The vendor handler must be called and answer
+ * through mctp_get_request()/mctp_send_response(), and the Get Message Type
+ * Support response must list all five commands in order.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_control_dispatch_table(void) {
+    uint8_t frame[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80, TEST_VENDOR_COMMAND};
+    uint16_t fcs = calc_fcs(0xffff, &frame[1], 9);
+    frame[10] = (uint8_t)(fcs >> 8); frame[11] = (uint8_t)(fcs & 0xFF); frame[12] = 0x7E;
+    mctp_init();
+    mock_clear_tx();
+    mock_set_rx_buffer(frame, sizeof(frame));
+    for (int it = 0; (it < 200) && !mctp_is_packet_available(); ++it) mctp_update();
+    if (require(mctp_is_packet_available(), "vendor request not received")) return 1;
+    vendor_command_calls = 0;
+    mctp_process_control_message();
+    if (require(vendor_command_calls == 1, "vendor handler called %d times", vendor_command_calls)) {
+        return 1;
+    }
+    mock_set_can_write(0);
+    while (mctp_send_frame() != 0) mock_set_can_write(0);
+    uint8_t out[64];
+    (void)unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+    const uint8_t reply[11] = {0x7E, 0x01, 0x09, 0x01, 0x08, 0x00, 0xC0, 0x00, 0x00,
+                               TEST_VENDOR_COMMAND, CONTROL_COMPLETE_SUCCESS};
+    if (require_u8_array_eq(reply, out, sizeof(reply))) return 1;
+    if (require(out[11] == 0x43, "request length echoed as 0x%02x", out[11])) return 1;
+    fcs = calc_fcs(0xffff, &out[1], 11);
+    if (require((out[12] == (fcs >> 8)) && (out[13] == (fcs & 0xFF)) && (out[14] == 0x7E),
+                "response FCS or trailer")) return 1;
+    if (require(mctp_send_response(5) == -1, "response sent without a request")) return 1;
+
+    frame[9] = CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT;
+    fcs = calc_fcs(0xffff, &frame[1], 9);
+    frame[10] = (uint8_t)(fcs >> 8); frame[11] = (uint8_t)(fcs & 0xFF);
+    if (require(test_send_control_message_and_wait_for_response(frame, sizeof(frame)) == 0,
+                "control response failed")) return 1;
+    (void)unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+    const uint8_t expected[7] = {CONTROL_COMPLETE_SUCCESS, 5, CONTROL_MSG_SET_ENDPOINT_ID,
+                                 CONTROL_MSG_GET_ENDPOINT_ID, CONTROL_MSG_GET_MCTP_VERSION_SUPPORT,
+                                 CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT, TEST_VENDOR_COMMAND};
+    if (require(out[2] == 4 + 3 + sizeof(expected), "byte count %u", out[2])) return 1;
+    return require_u8_array_eq(expected, &out[10], sizeof(expected));
+}
+
 /**
  * @brief Test that sequence tag and instance ID are propagated correctly.
  *
@@ -642,7 +1094,7 @@ int test_rx_invalid_escape_sequence(void) {
  * @return int 0 on success, 1 on failure.
  */
 int test_rx_buffer_boundary_accept(void) {
-    mock_clear_rx(); uint8_t hdr=0x01; const int max_body = MCTP_BUFFER_SIZE - 8; int byte_count = max_body; int total_len = byte_count + 6; uint8_t frame[256]; int i=0; frame[i++]=FRAME_CHAR; frame[i++]=hdr; frame[i++]=(uint8_t)byte_count; frame[i++]=hdr; frame[i++]=0x00; for (int k=2;k<byte_count;k++) frame[i++]=(uint8_t)(k&0xFF); uint16_t fcs = calc_fcs(0xffff, &frame[1], total_len - 4); frame[i++]=(uint8_t)(fcs>>8); frame[i++]=(uint8_t)(fcs&0xFF); frame[i++]=FRAME_CHAR;
+    mock_clear_rx(); uint8_t hdr=0x01; const int max_body = MCTP_BUFFER_SIZE - 8; int byte_count = max_body; int total_len = byte_count + 6; uint8_t frame[MCTP_BUFFER_SIZE]; int i=0; frame[i++]=FRAME_CHAR; frame[i++]=hdr; frame[i++]=(uint8_t)byte_count; frame[i++]=hdr; frame[i++]=0x00; for (int k=2;k<byte_count;k++) frame[i++]=(uint8_t)(k&0x3F); uint16_t fcs = calc_fcs(0xffff, &frame[1], total_len - 4); frame[i++]=(uint8_t)(fcs>>8); frame[i++]=(uint8_t)(fcs&0xFF); frame[i++]=FRAME_CHAR;
     mock_set_rx_buffer(frame, i); while (platform_serial_has_data()) mctp_update(); if (require(mctp_is_packet_available() || mock_tx_len() > 0, "expected packet or tx")) return 1; return 0;
 }
 
@@ -652,7 +1104,7 @@ int test_rx_buffer_boundary_accept(void) {
  * @return int 0 on success, 1 on failure.
  */
 int test_rx_buffer_boundary_reject(void) {
-    mock_clear_rx(); uint8_t hdr=0x01; const int over_body = (MCTP_BUFFER_SIZE - 8) + 1; int byte_count = over_body; int total_len = byte_count + 6; uint8_t frame[512]; int i=0; frame[i++]=FRAME_CHAR; frame[i++]=hdr; frame[i++]=(uint8_t)byte_count; frame[i++]=hdr; frame[i++]=0x00; for (int k=2;k<byte_count;k++) frame[i++]=(uint8_t)(k&0xFF); uint16_t fcs = calc_fcs(0xffff, &frame[1], total_len - 4); frame[i++]=(uint8_t)(fcs>>8); frame[i++]=(uint8_t)(fcs&0xFF); frame[i++]=FRAME_CHAR;
+    mock_clear_rx(); uint8_t hdr=0x01; const int over_body = (MCTP_BUFFER_SIZE - 8) + 1; int byte_count = over_body; int total_len = byte_count + 6; uint8_t frame[512]; int i=0; frame[i++]=FRAME_CHAR; frame[i++]=hdr; frame[i++]=(uint8_t)byte_count; frame[i++]=hdr; frame[i++]=0x00; for (int k=2;k<byte_count;k++) frame[i++]=(uint8_t)(k&0x3F); uint16_t fcs = calc_fcs(0xffff, &frame[1], total_len - 4); frame[i++]=(uint8_t)(fcs>>8); frame[i++]=(uint8_t)(fcs&0xFF); frame[i++]=FRAME_CHAR;
     mock_set_rx_buffer(frame, i); while (platform_serial_has_data()) mctp_update(); if (mctp_is_packet_available()) { mctp_process_control_message(); mock_set_can_write(1); int iter=0; while (mctp_send_frame() != 0 && iter++ < 100) mock_set_can_write(1); }
     if (mock_tx_len() > 0) { uint8_t out[256]; uint16_t out_len = unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out)); if (require(out_len > 10, "response too short")) return 1; if (require(out[10] != CONTROL_COMPLETE_SUCCESS, "unexpected success")) return 1; } else { if (require(mock_tx_len() == 0, "expected no tx")) return 1; }
     return 0;
@@ -676,6 +1128,39 @@ int test_malformed_bad_length_field(void) {
     mock_clear_rx(); mock_clear_tx(); uint8_t hdr=0x01; uint8_t body[] = {0x10,0x11,0x12}; uint8_t declared_count = 9; uint8_t buf[32]; int i=0; buf[i++]=FRAME_CHAR; buf[i++]=hdr; buf[i++]=declared_count; for (size_t k=0;k<sizeof(body);++k) buf[i++]=body[k]; uint16_t fcs = calc_fcs(0xffff, &buf[1], (int)(3 + sizeof(body) - 1)); buf[i++]=(uint8_t)(fcs>>8); buf[i++]=(uint8_t)(fcs&0xFF); buf[i++]=FRAME_CHAR; mock_set_rx_buffer(buf, i); while (platform_serial_has_data()) mctp_update(); if (require(!mctp_is_packet_available(), "packet incorrectly accepted")) return 1; if (require(mock_tx_len() == 0, "no tx expected")) return 1; return 0;
 }
 
+/**
+ * @brief Test rejection of a frame with a zero length field.
+ *
+ * A zero byte count must drop the frame at once rather than leave the framer
+ * counting body bytes down from 255 past the end of the buffer; a valid
+ * frame following the junk must then be received.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_malformed_zero_length(void) {
+    uint8_t buf[3 + 2 * MCTP_BUFFER_SIZE + 13];
+    int i = 0;
+    buf[i++] = FRAME_CHAR; buf[i++] = 0x01; buf[i++] = 0x00;
+    for (int k = 0; k < 2 * MCTP_BUFFER_SIZE; ++k) buf[i++] = 0x33;
+    int frame_start = i;
+    buf[i++] = FRAME_CHAR; buf[i++] = 0x01; buf[i++] = 0x07; buf[i++] = 0x01; buf[i++] = 0x00;
+    buf[i++] = 0x08; buf[i++] = 0xC8; buf[i++] = 0x00; buf[i++] = 0x80;
+    buf[i++] = CONTROL_MSG_GET_ENDPOINT_ID;
+    uint16_t fcs = calc_fcs(0xffff, &buf[frame_start + 1], 9);
+    buf[i++] = (uint8_t)(fcs >> 8); buf[i++] = (uint8_t)(fcs & 0xFF); buf[i++] = FRAME_CHAR;
+    mctp_init();
+    mock_clear_rx(); mock_clear_tx();
+    mock_set_rx_buffer(buf, (uint16_t)i);
+    for (int it = 0; (it < 200) && !mctp_is_packet_available(); ++it) {
+        mctp_update();
+        if (require(buffer_idx <= MCTP_BUFFER_SIZE, "index %u past the buffer", buffer_idx)) return 1;
+    }
+    if (require(mctp_is_packet_available(), "frame after the zero length not received")) return 1;
+    if (require(mctp_buffer[2] == 0x07, "wrong frame received")) return 1;
+    mctp_ignore_packet();
+    return 0;
+}
+
 /**
  * @brief Test rejection of frames missing the trailer byte.
  *
@@ -713,6 +1198,53 @@ int test_calc_fcs_concat_property(void) {
     return 0;
 }
 
+/**
+ * @brief Test the compiled FCS implementation against a bitwise reference.
+ *
+ * Covers every length up to `MCTP_BUFFER_SIZE` at several buffer alignments so
+ * the block and tail paths of the sliced implementations are exercised.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_calc_fcs_matches_bitwise(void) {
+    uint8_t buf[MCTP_BUFFER_SIZE + 8];
+    for (size_t i = 0; i < sizeof(buf); ++i) buf[i] = (uint8_t)(i * 37 + 11);
+    for (int offset = 0; offset < 8; ++offset) {
+        for (int len = 0; len <= MCTP_BUFFER_SIZE; ++len) {
+            uint16_t ref = 0xffff;
+            for (int i = 0; i < len; ++i) {
+                ref ^= buf[offset + i];
+                for (int b = 0; b < 8; ++b) ref = (ref & 1) ? (uint16_t)((ref >> 1) ^ 0x8408) : (uint16_t)(ref >> 1);
+            }
+            uint16_t f = calc_fcs(0xffff, &buf[offset], len);
+            if (require(f == ref, "calc_fcs mismatch offset=%d len=%d exp=0x%04x got=0x%04x", offset, len, ref, f)) return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Test the carry-less-multiply FCS kernel against `calc_fcs()`.
+ *
+ * Uses random data, random initial FCS values and random alignments for every
+ * length from 0 to 4096 bytes.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_calc_fcs_clmul_equivalence(void) {
+    static uint8_t buf[4096 + 16];
+    srand(12345);
+    for (size_t i = 0; i < sizeof(buf); ++i) buf[i] = (uint8_t)rand();
+    for (int len = 0; len <= 4096; ++len) {
+        int offset = rand() % 16;
+        uint16_t init = (len & 1) ? 0xffff : (uint16_t)rand();
+        uint16_t expected = calc_fcs(init, &buf[offset], len);
+        uint16_t actual = calc_fcs_clmul(init, &buf[offset], len);
+        if (require(expected == actual, "clmul mismatch len=%d exp=0x%04x got=0x%04x", len, expected, actual)) return 1;
+    }
+    return 0;
+}
+
 /**
  * @brief Test SET_ENDPOINT_ID operations that should be invalid (reset/discovery).
  *
@@ -782,71 +1314,1332 @@ int test_control_get_mctp_version_support_ff_and_unsupported(void) {
     return 0;
 }
 
-
-#if MCTP_EVENT_TX_ENABLED
-
 /**
- * @brief Test behavior when the event queue fills.
+ * @brief Test the FCS of constant control responses across varying headers.
  *
- * Enqueues two events and expects the second to fail.
+ * With MCTP_RESPONSE_TEMPLATES_ENABLED the FCS of these responses is built
+ * from a cached body contribution; every response must still carry the FCS
+ * calc_fcs() computes over the whole frame.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_slot_full(void) {
-    mock_clear_tx(); uint8_t evt_frame[9] = {0x7E,0x01,0x02,0x00,0x11,0x22,0x33,0x44,0x7E}; uint16_t fcs = calc_fcs(0xffff, &evt_frame[1], 5); evt_frame[5]=(uint8_t)(fcs>>8); evt_frame[6]=(uint8_t)(fcs&0xFF);
-    int r1 = mctp_send_event(evt_frame, 9); int r2 = mctp_send_event(evt_frame,9); if (require(r1==0, "enqueue failed")) return 1; if (require(r2!=0, "second enqueue should fail")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); return 0; }
+int test_control_response_fcs(void) {
+    const uint8_t sources[4] = {0x08, 0x21, 0x33, 0xFE};
+    const uint8_t requests[4][2] = {{CONTROL_MSG_GET_MCTP_VERSION_SUPPORT, 0x00},
+                                    {CONTROL_MSG_GET_MCTP_VERSION_SUPPORT, 0xFF},
+                                    {CONTROL_MSG_GET_MCTP_VERSION_SUPPORT, 0x02},
+                                    {CONTROL_MSG_GET_MESSAGE_TYPE_SUPPORT, 0x00}};
+    for (uint8_t r = 0; r < 4; ++r) {
+        for (uint8_t v = 0; v < 8; ++v) {
+            uint8_t frame[14] = {0x7E, 0x01, 0x08, 0x01, 0x00, sources[v & 3],
+                                 (uint8_t)(0xC8 | v), 0x00, (uint8_t)(0x80 | (v * 5)),
+                                 requests[r][0], requests[r][1]};
+            uint16_t fcs = calc_fcs(0xffff, &frame[1], 10);
+            frame[11] = (uint8_t)(fcs >> 8); frame[12] = (uint8_t)(fcs & 0xFF); frame[13] = 0x7E;
+            if (require(test_send_control_message_and_wait_for_response(frame, sizeof(frame)) == 0,
+                        "control response failed")) return 1;
+            uint8_t out[64];
+            uint16_t out_len = unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+            uint16_t end = (uint16_t)(out[2] + 3);
+            if (require(out_len == end + 3, "response length %u", out_len)) return 1;
+            const uint8_t header[9] = {0x7E, 0x01, out[2], 0x01, sources[v & 3], 0x00,
+                                       (uint8_t)(0xC0 | v), 0x00, (uint8_t)(v * 5)};
+            if (require_u8_array_eq(header, out, sizeof(header))) return 1;
+            fcs = calc_fcs(0xffff, &out[1], end - 1);
+            if (require((out[end] == (fcs >> 8)) && (out[end + 1] == (fcs & 0xFF)),
+                        "response FCS for command 0x%02x type 0x%02x header %u", requests[r][0],
+                        requests[r][1], v)) return 1;
+        }
+    }
+    return 0;
+}
+
+/* In-memory serial link for endpoints driven through mctp_init_ctx() */
+struct test_link {
+    uint8_t rx[2 * MCTP_BUFFER_SIZE]; /* one escaped frame */
+    uint16_t rx_len;
+    uint16_t rx_pos;
+    uint8_t tx[64];
+    uint16_t tx_len;
+    int inits;
+};
+
+static void test_link_init(void* platform) {
+    ((struct test_link*)platform)->inits++;
+}
+
+static uint16_t test_link_read(void* platform, uint8_t* buf, uint16_t max) {
+    struct test_link* l = (struct test_link*)platform;
+    uint16_t n = (uint16_t)(l->rx_len - l->rx_pos);
+    if (n > max) n = max;
+    memcpy(buf, &l->rx[l->rx_pos], n);
+    l->rx_pos = (uint16_t)(l->rx_pos + n);
+    return n;
+}
 
+static uint16_t test_link_write(void* platform, const uint8_t* buf, uint16_t len) {
+    struct test_link* l = (struct test_link*)platform;
+    uint16_t n = (uint16_t)(sizeof(l->tx) - l->tx_len);
+    if (n > len) n = len;
+    memcpy(&l->tx[l->tx_len], buf, n);
+    l->tx_len = (uint16_t)(l->tx_len + n);
+    return n;
+}
+
+static const mctp_platform_ops_t test_link_ops = {
+    .init = test_link_init, .read = test_link_read, .write = test_link_write, .millis = NULL};
 
 /**
- * @brief Test that an event waits for the current primary frame to finish.
+ * @brief Deliver a control request over a test link and run its endpoint until it answers.
  *
- * Ensures event frames are sent as a second frame following the primary.
+ * @param ep Endpoint attached to `link`.
+ * @param link Link of the endpoint; its transmit side is cleared first.
+ * @param frame Request frame (no bytes needing escapes).
+ * @param len Length of `frame`.
+ */
+static void test_link_request(mctp_endpoint_t* ep, struct test_link* link, const uint8_t* frame,
+                              uint16_t len) {
+#if MCTP_RX_RING_ENABLED
+    (void)mctp_ring_write(&ep->rx_ring, frame, len); /* the link's receive interrupt */
+#else
+    memcpy(link->rx, frame, len);
+    link->rx_len = len;
+    link->rx_pos = 0;
+#endif
+    link->tx_len = 0;
+    for (int it = 0; it < 100; ++it) {
+        mctp_update_ctx(ep);
+        if (mctp_is_packet_available_ctx(ep)) {
+            mctp_process_control_message_ctx(ep);
+        }
+    }
+}
+
+/**
+ * @brief Test endpoints driven through the context API, side by side.
+ *
+ * Two endpoints on their own in-memory links are assigned different EIDs and
+ * must each answer on their own link only, while the default endpoint behind
+ * the plain API is left untouched.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_waits_for_current_frame(void) {
-    mock_clear_tx(); uint8_t prim[9] = {0x7E,0x01,0x02,0x00,0xAA,0xBB,0xCC,0xDD,0x7E}; uint16_t fcs = calc_fcs(0xffff, &prim[1], 5); prim[5]=(uint8_t)(fcs>>8); prim[6]=(uint8_t)(fcs&0xFF);
-    { uint16_t _len = 9; if (_len > MCTP_BUFFER_SIZE) _len = MCTP_BUFFER_SIZE; for (uint16_t _i=0; _i<_len; ++_i) mctp_buffer[_i]=prim[_i]; if (_len>2) mctp_buffer[2] = (uint8_t)((_len>=6)?(_len-6):0); buffer_idx=(uint8_t)_len; rxState = MCTPSER_AWAITING_RESPONSE; }
-    mock_set_can_write(1); mctp_send_frame(); uint8_t evt[9] = {0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; fcs = calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r = mctp_send_event(evt,9); if (require(r==0, "enqueue event failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1);
-    const uint8_t* tx = mock_tx_buffer(); uint16_t txlen = mock_tx_len(); if (require(txlen >= 18, "tx too short")) return 1; if (require(tx[0] == 0x7E, "first frame missing")) return 1; int found=0; for (uint16_t i=1;i<txlen;++i) if (tx[i]==0x7E) { found=1; break; } if (require(found, "second frame not found")) return 1; return 0; }
+int test_endpoint_contexts(void) {
+    static mctp_endpoint_t eps[2];
+    static struct test_link links[2];
+    uint8_t out[64];
+    uint8_t default_eid = mctp_get_endpoint_id();
+    for (int i = 0; i < 2; ++i) {
+        memset(&links[i], 0, sizeof(links[i]));
+        mctp_init_ctx(&eps[i], &test_link_ops, &links[i]);
+        if (require(links[i].inits == 1, "link %d initialized %d times", i, links[i].inits)) {
+            return 1;
+        }
+        if (require(mctp_get_endpoint_id_ctx(&eps[i]) == 0, "endpoint %d programmed", i)) return 1;
+    }
 
+    /* Set Endpoint ID: endpoint i becomes EID 0x21 + i */
+    for (int i = 0; i < 2; ++i) {
+        uint8_t set[15] = {0x7E, 0x01, 0x09, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80,
+                           CONTROL_MSG_SET_ENDPOINT_ID, 0x00, (uint8_t)(0x21 + i)};
+        uint16_t fcs = calc_fcs(0xffff, &set[1], 11);
+        set[12] = (uint8_t)(fcs >> 8); set[13] = (uint8_t)(fcs & 0xFF); set[14] = 0x7E;
+        test_link_request(&eps[i], &links[i], set, sizeof(set));
+        uint16_t n = unescape_tx(links[i].tx, links[i].tx_len, out, sizeof(out));
+        if (require(n == 17, "set eid response %u bytes", n)) return 1;
+        if (require(out[12] == 0x00, "endpoint %d reported a previous eid", i)) return 1;
+        if (require(mctp_get_endpoint_id_ctx(&eps[i]) == 0x21 + i, "endpoint %d eid", i)) return 1;
+    }
+
+    /* Get Endpoint ID addressed to 0x21 is answered by endpoint 0 and dropped by endpoint 1 */
+    uint8_t get[13] = {0x7E, 0x01, 0x07, 0x01, 0x21, 0x08, 0xC9, 0x00, 0x81,
+                       CONTROL_MSG_GET_ENDPOINT_ID};
+    uint16_t fcs = calc_fcs(0xffff, &get[1], 9);
+    get[10] = (uint8_t)(fcs >> 8); get[11] = (uint8_t)(fcs & 0xFF); get[12] = 0x7E;
+    for (int i = 0; i < 2; ++i) {
+        test_link_request(&eps[i], &links[i], get, sizeof(get));
+    }
+    const uint8_t reply[13] = {0x7E, 0x01, 0x0A, 0x01, 0x08, 0x21, 0xC1, 0x00, 0x01,
+                               CONTROL_MSG_GET_ENDPOINT_ID, CONTROL_COMPLETE_SUCCESS, 0x21, 0x00};
+    uint16_t n = unescape_tx(links[0].tx, links[0].tx_len, out, sizeof(out));
+    if (require(n == 16, "get eid response %u bytes", n)) return 1;
+    if (require_u8_array_eq(reply, out, sizeof(reply))) return 1;
+    if (require(links[1].tx_len == 0, "endpoint 1 answered a request for 0x21")) return 1;
+    if (require(mctp_get_endpoint_id() == default_eid, "default endpoint changed")) return 1;
+    return 0;
+}
 
+#if !MCTP_RX_RING_ENABLED
 /**
- * @brief Test event priority when primary is idle.
+ * @brief Collect one frame from the bus owner side of a pty, servicing the endpoint meanwhile.
+ *
+ * @param epoll_fd Loop of the endpoint's port.
+ * @param master Bus owner side of the pty (non-blocking).
+ * @param out Destination for the raw frame.
+ * @param max Size of `out`.
+ * @return uint16_t Raw frame length, or 0 when no frame arrived within about a second.
+ */
+static uint16_t pty_read_frame(int epoll_fd, int master, uint8_t* out, uint16_t max) {
+    uint16_t len = 0;
+    for (int it = 0; it < 100; ++it) {
+        if (mctp_linux_poll(epoll_fd, 10) < 0) return 0;
+        uint8_t b;
+        while ((len < max) && (read(master, &b, 1) == 1)) {
+            if ((len == 0) && (b != 0x7E)) continue;
+            out[len++] = b;
+            if ((len > 3) && (b == 0x7E)) return len;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Test the Linux backend end to end over a pty pair.
  *
- * Verifies events are sent before primary frames when idle.
+ * An endpoint on the pty slave, driven by the epoll loop, is assigned an EID
+ * and answers a Get Endpoint ID request written by the bus owner on the
+ * master.  Once idle it must not wake the loop, and a message larger than the
+ * pty buffers must reach the bus owner through blocked writes and EPOLLOUT.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_priority_before_primary_when_idle(void) {
-    mock_clear_tx(); uint8_t prim[9]={0x7E,0x01,0x02,0x00,0xAA,0xBB,0xCC,0xDD,0x7E}; uint16_t fcs=calc_fcs(0xffff,&prim[1],5); prim[5]=(uint8_t)(fcs>>8); prim[6]=(uint8_t)(fcs&0xFF);
-    { uint16_t _len=9; if (_len>MCTP_BUFFER_SIZE) _len=MCTP_BUFFER_SIZE; for (uint16_t _i=0;_i<_len;++_i) mctp_buffer[_i]=prim[_i]; if (_len>2) mctp_buffer[2]=(uint8_t)((_len>=6)?(_len-6):0); buffer_idx=(uint8_t)_len; rxState=MCTPSER_AWAITING_RESPONSE; }
-    uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue event failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); const uint8_t* tx=mock_tx_buffer(); if (require(tx[0]==0x7E,"first byte not frame")) return 1; uint8_t out[64]; uint16_t out_len = unescape_tx(tx, mock_tx_len(), out, sizeof(out)); (void)out_len; if (require(out[4]==0x10, "first frame destination mismatch")) return 1; return 0; }
+int test_linux_pty_loopback(void) {
+    static mctp_endpoint_t ep;
+    mctp_linux_port_t port;
+    uint8_t frame[64];
+    uint8_t out[64];
+    int result = 1;
+
+    memset(&ep, 0, sizeof(ep));
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (require(master >= 0, "posix_openpt failed")) return 1;
+    if (require((grantpt(master) == 0) && (unlockpt(master) == 0), "pty unlock failed")) {
+        close(master);
+        return 1;
+    }
+    (void)fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    if (require(mctp_linux_open(&port, ptsname(master), 115200) == 0, "open %s", ptsname(master))) {
+        close(master);
+        return 1;
+    }
+    int epoll_fd = mctp_linux_loop_create();
+    if (require(epoll_fd >= 0, "epoll_create1 failed")) goto done;
+    if (require(mctp_linux_add(epoll_fd, &port, &ep, NULL) == 0, "port not added")) goto done;
+
+    /* Set Endpoint ID 0x30 */
+    uint8_t set[15] = {0x7E, 0x01, 0x09, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80,
+                       CONTROL_MSG_SET_ENDPOINT_ID, 0x00, 0x30};
+    uint16_t fcs = calc_fcs(0xffff, &set[1], 11);
+    set[12] = (uint8_t)(fcs >> 8); set[13] = (uint8_t)(fcs & 0xFF); set[14] = 0x7E;
+    if (require(write(master, set, sizeof(set)) == (ssize_t)sizeof(set), "request not written")) {
+        goto done;
+    }
+    uint16_t n = pty_read_frame(epoll_fd, master, frame, sizeof(frame));
+    if (require(n != 0, "no set eid response")) goto done;
+    n = unescape_tx(frame, n, out, sizeof(out));
+    if (require((n == 17) && (out[10] == CONTROL_COMPLETE_SUCCESS), "set eid response")) goto done;
+    if (require(mctp_get_endpoint_id_ctx(&ep) == 0x30, "eid not assigned")) goto done;
+
+    /* Get Endpoint ID addressed to the new EID */
+    uint8_t get[13] = {0x7E, 0x01, 0x07, 0x01, 0x30, 0x08, 0xC9, 0x00, 0x81,
+                       CONTROL_MSG_GET_ENDPOINT_ID};
+    fcs = calc_fcs(0xffff, &get[1], 9);
+    get[10] = (uint8_t)(fcs >> 8); get[11] = (uint8_t)(fcs & 0xFF); get[12] = 0x7E;
+    if (require(write(master, get, sizeof(get)) == (ssize_t)sizeof(get), "request not written")) {
+        goto done;
+    }
+    n = pty_read_frame(epoll_fd, master, frame, sizeof(frame));
+    if (require(n != 0, "no get eid response")) goto done;
+    const uint8_t reply[13] = {0x7E, 0x01, 0x0A, 0x01, 0x08, 0x30, 0xC1, 0x00, 0x01,
+                               CONTROL_MSG_GET_ENDPOINT_ID, CONTROL_COMPLETE_SUCCESS, 0x30, 0x00};
+    (void)unescape_tx(frame, n, out, sizeof(out));
+    if (require_u8_array_eq(reply, out, sizeof(reply))) goto done;
+
+    /* an idle endpoint leaves the loop asleep */
+    if (require(mctp_linux_poll(epoll_fd, 20) == 0, "idle endpoint woke the loop")) goto done;
+
+#if MCTP_FRAGMENTATION_ENABLED
+    /* a message larger than the pty buffers: the endpoint must block and resume */
+    static uint8_t msg[20000];
+    memset(msg, 0x11, sizeof(msg));
+    if (require(mctp_send_message_ctx(&ep, 0x08, 0x08, msg, sizeof(msg)) == 0, "send refused")) {
+        goto done;
+    }
+    mctp_linux_service(&port);
+    if (require(port.events == EPOLLOUT, "port not waiting for writability")) goto done;
+    uint32_t unit = (uint32_t)mctp_get_transmission_unit_ctx(&ep) - 4;
+    uint32_t expect = sizeof(msg) + 10 * ((sizeof(msg) + unit - 1) / unit);
+    uint32_t logical = 0;
+    uint8_t escaped = 0;
+    for (int it = 0; (it < 1000) && (logical < expect); ++it) {
+        uint8_t chunk[512];
+        ssize_t r;
+        while ((r = read(master, chunk, sizeof(chunk))) > 0) {
+            for (ssize_t k = 0; k < r; ++k) {
+                if (escaped || (chunk[k] != 0x7D)) logical++;
+                escaped = (uint8_t)(!escaped && (chunk[k] == 0x7D));
+            }
+        }
+        if (mctp_linux_poll(epoll_fd, 10) < 0) break;
+    }
+    if (require(logical == expect, "received %u of %u bytes", logical, expect)) goto done;
+    if (require(!mctp_is_message_sending_ctx(&ep), "message still sending")) goto done;
+    if (require(port.events == EPOLLIN, "port not back to readability")) goto done;
+#endif
+    result = 0;
+done:
+    mctp_linux_close(&port);
+    if (epoll_fd >= 0) close(epoll_fd);
+    close(master);
+    return result;
+}
+#endif /* !MCTP_RX_RING_ENABLED */
 
+/**
+ * @brief Answer a Get Endpoint ID request over the UART model, as examples/main.c would.
+ *
+ * The request is injected at virtual time 0 and the main loop runs once per
+ * `loop_ns` of virtual time for 20 ms, long enough for the slowest line
+ * configuration used by the tests.
+ *
+ * @param config UART model parameters.
+ * @param loop_ns Virtual time per main loop iteration.
+ * @param stats Set to the model statistics at the end of the run.
+ */
+static void uart_model_get_eid(const mock_uart_config_t* config, uint64_t loop_ns,
+                               mock_uart_stats_t* stats) {
+    uint8_t request[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80,
+                           CONTROL_MSG_GET_ENDPOINT_ID};
+    uint16_t fcs = calc_fcs(0xffff, &request[1], 9);
+    request[10] = (uint8_t)(fcs >> 8); request[11] = (uint8_t)(fcs & 0xFF); request[12] = 0x7E;
+    mctp_init();
+    mock_uart_enable(config);
+    mock_uart_rx_inject(request, sizeof(request));
+    while (mock_uart_now() < 20000000u) {
+        mctp_update();
+        if (mctp_is_packet_available()) {
+            mctp_process_control_message();
+        }
+        mock_uart_advance(loop_ns);
+    }
+    mock_uart_get_stats(stats);
+    mock_uart_enable(NULL);
+}
 
 /**
- * @brief Test event queue is empty initially.
+ * @brief Test request-to-response latency and line utilization under the UART model.
+ *
+ * With deep FIFOs the response leaves back to back, one character time per
+ * byte, within an interrupt latency and a loop period of the request's last
+ * byte.  With a one-byte transmit FIFO every byte waits for the interrupt
+ * that refills it, so the line is mostly idle.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_queue_empty_initial(void) { mock_clear_tx(); if (require(mctp_is_event_queue_empty() == 1, "event queue not empty initially")) return 1; return 0; }
+int test_uart_model_latency(void) {
+    mock_uart_stats_t st;
+    const mock_uart_config_t fifo16 = {.baud = 115200, .bits_per_char = 10, .tx_fifo = 16,
+                                       .rx_fifo = 16, .gap_ns = 0, .isr_latency_ns = 20000};
+    const uint64_t char16 = 86806; /* 10 bits at 115200 baud, rounded */
+    uart_model_get_eid(&fifo16, 10000, &st);
+    if (require((st.rx_bytes == 13) && (st.tx_bytes >= 16), "%u bytes in, %u out", st.rx_bytes,
+                st.tx_bytes)) return 1;
+    uint64_t latency = st.tx_done_ns - st.rx_done_ns;
+    if (require((latency >= st.tx_bytes * char16) &&
+                (latency <= st.tx_bytes * char16 + 20000 + 2 * 10000),
+                "latency %llu ns for %u bytes", (unsigned long long)latency, st.tx_bytes)) {
+        return 1;
+    }
+    if (require(st.tx_busy_ns * 100 >= latency * 95, "line utilization %llu%%",
+                (unsigned long long)(st.tx_busy_ns * 100 / latency))) return 1;
 
+    const mock_uart_config_t fifo1 = {.baud = 1000000, .bits_per_char = 10, .tx_fifo = 1,
+                                      .rx_fifo = 16, .gap_ns = 0, .isr_latency_ns = 50000};
+    uart_model_get_eid(&fifo1, 5000, &st);
+    latency = st.tx_done_ns - st.rx_done_ns;
+    if (require(st.tx_bytes >= 16, "%u bytes out", st.tx_bytes)) return 1;
+    if (require(latency >= st.tx_bytes * 10000 + (st.tx_bytes - 1) * 50000,
+                "latency %llu ns hides the refill interrupts", (unsigned long long)latency)) {
+        return 1;
+    }
+    if (require(st.tx_busy_ns * 100 < latency * 25, "line utilization %llu%%",
+                (unsigned long long)(st.tx_busy_ns * 100 / latency))) return 1;
+    return 0;
+}
 
 /**
- * @brief Test event queue is non-empty after enqueue.
+ * @brief Test receive FIFO overruns under the UART model.
+ *
+ * A request arriving faster than a slow interrupt empties a 4-byte FIFO
+ * loses bytes and goes unanswered; with a prompt interrupt it is answered.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_queue_not_empty_after_enqueue(void) { mock_clear_tx(); uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; uint16_t fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue failed")) return 1; if (require(mctp_is_event_queue_empty() == 0, "queue still empty after enqueue")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); return 0; }
+int test_uart_model_rx_overrun(void) {
+    mock_uart_stats_t st;
+    mock_uart_config_t cfg = {.baud = 1000000, .bits_per_char = 10, .tx_fifo = 16,
+                              .rx_fifo = 4, .gap_ns = 0, .isr_latency_ns = 100000};
+    uart_model_get_eid(&cfg, 5000, &st);
+    if (require(st.rx_overruns != 0, "no overruns with a 100 us interrupt latency")) return 1;
+    if (require(st.tx_bytes == 0, "corrupted request answered")) return 1;
+
+    cfg.isr_latency_ns = 20000; /* two character times: the FIFO never fills */
+    uart_model_get_eid(&cfg, 5000, &st);
+    if (require(st.rx_overruns == 0, "%u overruns with a 20 us latency", st.rx_overruns)) return 1;
+    if (require(st.tx_bytes >= 16, "request not answered")) return 1;
+    return 0;
+}
 
 
 /**
- * @brief Test event queue empties after transmit.
+ * @brief Test ring size validation, wrap-around and the overflow counter.
  *
  * @return int 0 on success, 1 on failure.
  */
-int test_event_queue_empty_after_transmit(void) { mock_clear_tx(); uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; uint16_t fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); if (require(mctp_is_event_queue_empty() == 1, "queue not empty after transmit")) return 1; return 0; }
-#endif
+int test_ring_wrap_and_overflow(void) {
+    mctp_ring_t ring;
+    uint8_t storage[8];
+    uint8_t out[16];
+    if (require(mctp_ring_init(&ring, storage, 6) != 0, "non power-of-two size accepted")) return 1;
+    if (require(mctp_ring_init(&ring, storage, 0) != 0, "zero size accepted")) return 1;
+    if (require(mctp_ring_init(&ring, storage, 8) == 0, "size 8 rejected")) return 1;
+
+    /* move the indices so later writes straddle the end of the storage */
+    for (int i = 0; i < 5; ++i) mctp_ring_put(&ring, (uint8_t)i);
+    if (require(mctp_ring_read(&ring, out, 16) == 5, "expected 5 bytes")) return 1;
+
+    uint8_t data[10] = {10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    if (require(mctp_ring_write(&ring, data, 10) == 8, "expected 8 bytes stored")) return 1;
+    if (require(mctp_ring_overflows(&ring) == 2, "expected 2 overflows, got %u",
+                (unsigned)mctp_ring_overflows(&ring))) return 1;
+    if (require(mctp_ring_put(&ring, 0x55) == 0, "put into full ring succeeded")) return 1;
+    if (require(mctp_ring_overflows(&ring) == 3, "expected 3 overflows")) return 1;
+    if (require(mctp_ring_count(&ring) == 8, "expected 8 bytes queued")) return 1;
+    if (require(mctp_ring_read(&ring, out, 3) == 3, "expected 3 bytes")) return 1;
+    if (require(mctp_ring_read(&ring, out + 3, 16) == 5, "expected 5 bytes")) return 1;
+    if (require_u8_array_eq(data, out, 8)) return 1;
+    if (require(mctp_ring_count(&ring) == 0, "ring not empty")) return 1;
+    return 0;
+}
+
+#define RING_STRESS_BYTES 1000000u
+
+struct ring_stress {
+    mctp_ring_t ring;
+    uint8_t storage[64];
+    uint32_t rejected; /* bytes the producer was refused (the overflows it expects) */
+};
+
+/**
+ * @brief Producer thread: pushes a counting pattern, alternating single puts and blocks.
+ *
+ * Refused bytes are retried, so the consumer must see the complete pattern.
+ *
+ * @param arg The shared `struct ring_stress`.
+ * @return void* NULL.
+ */
+static void* ring_stress_producer(void* arg) {
+    struct ring_stress* st = (struct ring_stress*)arg;
+    uint8_t block[37];
+    uint32_t sent = 0;
+    while (sent < RING_STRESS_BYTES) {
+        if ((sent & 0x100u) == 0) {
+            if (mctp_ring_put(&st->ring, (uint8_t)(sent * 7u))) {
+                ++sent;
+            } else {
+                ++st->rejected;
+                sched_yield();
+            }
+        } else {
+            uint16_t len = (uint16_t)(1u + sent % sizeof(block));
+            if (len > RING_STRESS_BYTES - sent) len = (uint16_t)(RING_STRESS_BYTES - sent);
+            for (uint16_t i = 0; i < len; ++i) block[i] = (uint8_t)((sent + i) * 7u);
+            uint16_t n = mctp_ring_write(&st->ring, block, len);
+            st->rejected += (uint32_t)(len - n);
+            sent += n;
+            if (n < len) sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Stress the ring with a producer and a consumer on separate threads.
+ *
+ * The consumer reads in varying chunk sizes and checks that every byte
+ * arrives exactly once and in order, and that the overflow counter matches
+ * the number of bytes the producer was refused.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_ring_spsc_stress(void) {
+    static struct ring_stress st;
+    uint8_t out[48];
+    uint32_t received = 0;
+    st.rejected = 0;
+    if (require(mctp_ring_init(&st.ring, st.storage, sizeof(st.storage)) == 0, "init failed")) {
+        return 1;
+    }
+    pthread_t producer;
+    if (require(pthread_create(&producer, NULL, ring_stress_producer, &st) == 0,
+                "pthread_create failed")) return 1;
+    while (received < RING_STRESS_BYTES) {
+        uint16_t n = mctp_ring_read(&st.ring, out, (uint16_t)(1u + received % sizeof(out)));
+        for (uint16_t i = 0; i < n; ++i) {
+            if (out[i] != (uint8_t)((received + i) * 7u)) {
+                pthread_join(producer, NULL);
+                record_failure(__FILE__, __LINE__, "byte %u corrupted", (unsigned)(received + i));
+                return 1;
+            }
+        }
+        received += n;
+        /* let the producer run when the host has a single CPU */
+        if (n == 0) sched_yield();
+    }
+    pthread_join(producer, NULL);
+    if (require(mctp_ring_count(&st.ring) == 0, "ring not empty after stress")) return 1;
+    if (require(mctp_ring_overflows(&st.ring) == st.rejected, "overflows %u != rejected %u",
+                (unsigned)mctp_ring_overflows(&st.ring), (unsigned)st.rejected)) return 1;
+    return 0;
+}
+
+#if MCTP_RX_RING_ENABLED
+/**
+ * @brief Test frames pushed into the receive ring by the UART interrupt.
+ *
+ * A Get Endpoint ID request written into `mctp_rx_ring` must be received and
+ * answered without the platform read op.  Bytes pushed into a full ring are
+ * dropped and counted, and a frame pushed once the ring has drained must
+ * still come out.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_ring_update_frames(void) {
+    uint8_t frame[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80,
+                         CONTROL_MSG_GET_ENDPOINT_ID};
+    uint16_t fcs = calc_fcs(0xffff, &frame[1], 9);
+    frame[10] = (uint8_t)(fcs >> 8); frame[11] = (uint8_t)(fcs & 0xFF); frame[12] = 0x7E;
+    mctp_init();
+    mock_clear_rx();
+    mock_clear_tx();
+    if (require(mctp_ring_write(&mctp_rx_ring, frame, sizeof(frame)) == sizeof(frame),
+                "frame not queued")) return 1;
+    for (int it = 0; (it < 100) && !mctp_is_packet_available(); ++it) mctp_update();
+    if (require(mctp_is_packet_available(), "request not received from the ring")) return 1;
+    mctp_process_control_message();
+    mock_set_can_write(1);
+    for (int it = 0; (it < 100) && (mctp_send_frame() != 0); ++it) mock_set_can_write(1);
+    uint8_t out[64];
+    (void)unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+    const uint8_t reply[11] = {0x7E, 0x01, 0x0A, 0x01, 0x08, 0x00, 0xC0, 0x00, 0x00,
+                               CONTROL_MSG_GET_ENDPOINT_ID, CONTROL_COMPLETE_SUCCESS};
+    if (require_u8_array_eq(reply, out, sizeof(reply))) return 1;
+
+    /* the interrupt outruns the main loop: the ring fills and drops the excess */
+    uint8_t noise[MCTP_RX_RING_SIZE + 5];
+    memset(noise, 0x55, sizeof(noise));
+    if (require(mctp_ring_write(&mctp_rx_ring, noise, sizeof(noise)) == MCTP_RX_RING_SIZE,
+                "full ring accepted bytes")) return 1;
+    if (require(mctp_ring_overflows(&mctp_rx_ring) == 5, "expected 5 overflows, got %u",
+                (unsigned)mctp_ring_overflows(&mctp_rx_ring))) return 1;
+    for (int it = 0; (it < 100) && (mctp_ring_count(&mctp_rx_ring) != 0); ++it) mctp_update();
+    if (require(mctp_ring_count(&mctp_rx_ring) == 0, "ring not drained")) return 1;
+    if (require(!mctp_is_packet_available(), "noise accepted as a packet")) return 1;
+
+    mock_clear_tx();
+    (void)mctp_ring_write(&mctp_rx_ring, frame, sizeof(frame));
+    for (int it = 0; (it < 100) && !mctp_is_packet_available(); ++it) mctp_update();
+    if (require(mctp_is_packet_available(), "request after overflow not received")) return 1;
+    mctp_process_control_message();
+    mock_set_can_write(1);
+    for (int it = 0; (it < 100) && (mctp_send_frame() != 0); ++it) mock_set_can_write(1);
+    (void)unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+    if (require_u8_array_eq(reply, out, sizeof(reply))) return 1;
+    return 0;
+}
+#endif /* MCTP_RX_RING_ENABLED */
+
+/**
+ * @brief Test reassembly of a message sent as three packets.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_reasm_in_order(void) {
+    static mctp_reasm_t r;
+    uint8_t part[3][20];
+    uint8_t index = 0xFF;
+    mctp_reasm_init(&r);
+    for (int p = 0; p < 3; ++p) {
+        for (int k = 0; k < 20; ++k) part[p][k] = (uint8_t)(20 * p + k);
+    }
+    if (require(mctp_reasm_packet(&r, 8, MCTP_FLAG_SOM | 0x00 | MCTP_FLAG_TO | 3, part[0], 20, 0,
+                                  &index) == MCTP_REASM_PENDING, "first packet")) return 1;
+    /* a packet of another tag from the same source does not disturb the message */
+    if (require(mctp_reasm_packet(&r, 8, 0x10 | MCTP_FLAG_TO | 4, part[1], 20, 0, &index) ==
+                MCTP_REASM_UNKNOWN, "unrelated packet accepted")) return 1;
+    if (require(mctp_reasm_packet(&r, 8, 0x10 | MCTP_FLAG_TO | 3, part[1], 20, 0, &index) ==
+                MCTP_REASM_PENDING, "second packet")) return 1;
+    if (require(mctp_reasm_packet(&r, 8, MCTP_FLAG_EOM | 0x20 | MCTP_FLAG_TO | 3, part[2], 20, 0,
+                                  &index) == MCTP_REASM_COMPLETE, "last packet")) return 1;
+    uint16_t len = 0;
+    const uint8_t* msg = mctp_reasm_message(&r, index, &len);
+    if (require((msg != NULL) && (len == 60), "message length %u", len)) return 1;
+    for (int k = 0; k < 60; ++k) {
+        if (require(msg[k] == k, "byte %d wrong", k)) return 1;
+    }
+    mctp_reasm_release(&r, index);
+    if (require(mctp_reasm_message(&r, index, &len) == NULL, "message not released")) return 1;
+    return 0;
+}
+
+/**
+ * @brief Test that a missing packet drops the message.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_reasm_sequence_error(void) {
+    static mctp_reasm_t r;
+    uint8_t data[8] = {0};
+    uint8_t index;
+    mctp_reasm_init(&r);
+    (void)mctp_reasm_packet(&r, 9, MCTP_FLAG_SOM | 0x30 | 1, data, 8, 0, &index);
+    /* sequence 0 follows 3; sequence 1 means a packet was lost */
+    if (require(mctp_reasm_packet(&r, 9, 0x10 | 1, data, 8, 0, &index) == MCTP_REASM_SEQUENCE,
+                "gap not detected")) return 1;
+    if (require(mctp_reasm_packet(&r, 9, MCTP_FLAG_EOM | 0x20 | 1, data, 8, 0, &index) ==
+                MCTP_REASM_UNKNOWN, "dropped message still open")) return 1;
+    if (require(r.sequence_errors == 1, "sequence errors %u", (unsigned)r.sequence_errors)) {
+        return 1;
+    }
+    /* the wrap from 3 to 0 is in sequence */
+    (void)mctp_reasm_packet(&r, 9, MCTP_FLAG_SOM | 0x30 | 1, data, 8, 0, &index);
+    if (require(mctp_reasm_packet(&r, 9, MCTP_FLAG_EOM | 0x00 | 1, data, 8, 0, &index) ==
+                MCTP_REASM_COMPLETE, "wrapped sequence rejected")) return 1;
+    /* oversized messages are refused rather than overflowing the region */
+    static uint8_t big[MCTP_REASM_MAX_MESSAGE];
+    (void)mctp_reasm_packet(&r, 7, MCTP_FLAG_SOM, big, MCTP_REASM_MAX_MESSAGE, 0, &index);
+    if (require(mctp_reasm_packet(&r, 7, 0x10, data, 1, 0, &index) == MCTP_REASM_TOO_LONG,
+                "oversized message accepted")) return 1;
+    return 0;
+}
+
+/**
+ * @brief Test timeouts and eviction of stalled messages.
+ *
+ * A message that sees no packet for longer than MCTP_REASM_TIMEOUT_MS is
+ * dropped by mctp_reasm_expire().  When every region is busy, a new message
+ * evicts the oldest one still being assembled, but never a completed one.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_reasm_timeout_and_eviction(void) {
+    static mctp_reasm_t r;
+    uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t index;
+    mctp_reasm_init(&r);
+    (void)mctp_reasm_packet(&r, 5, MCTP_FLAG_SOM, data, 4, 1000, &index);
+    if (require(mctp_reasm_expire(&r, 1000 + MCTP_REASM_TIMEOUT_MS) == 0, "expired early")) {
+        return 1;
+    }
+    if (require(mctp_reasm_expire(&r, 1001 + MCTP_REASM_TIMEOUT_MS) == 1, "not expired")) return 1;
+    if (require(mctp_reasm_packet(&r, 5, MCTP_FLAG_EOM | 0x10, data, 4, 1200, &index) ==
+                MCTP_REASM_UNKNOWN, "expired message still open")) return 1;
+
+    /* fill every region with completed messages except one stalled message */
+    mctp_reasm_init(&r);
+    for (uint8_t src = 0; src < MCTP_REASM_MESSAGES - 1; ++src) {
+        (void)mctp_reasm_packet(&r, src, MCTP_FLAG_SOM | MCTP_FLAG_EOM, data, 4, 0, &index);
+    }
+    (void)mctp_reasm_packet(&r, 0x40, MCTP_FLAG_SOM, data, 4, 0, &index);
+    if (require(mctp_reasm_packet(&r, 0x41, MCTP_FLAG_SOM, data, 4, 0, &index) ==
+                MCTP_REASM_PENDING, "new message not admitted")) return 1;
+    if (require(mctp_reasm_packet(&r, 0x40, MCTP_FLAG_EOM | 0x10, data, 4, 0, &index) ==
+                MCTP_REASM_UNKNOWN, "stalled message not evicted")) return 1;
+    if (require(mctp_reasm_packet(&r, 0x42, MCTP_FLAG_SOM, data, 4, 0, &index) ==
+                MCTP_REASM_PENDING, "second eviction failed")) return 1;
+    if (require(mctp_reasm_packet(&r, 0x41, MCTP_FLAG_EOM | 0x10, data, 4, 0, &index) ==
+                MCTP_REASM_UNKNOWN, "evicted message still open")) return 1;
+    (void)mctp_reasm_packet(&r, 0x42, MCTP_FLAG_EOM | 0x10, data, 4, 0, &index);
+    /* now every region holds a completed message */
+    if (require(mctp_reasm_packet(&r, 0x43, MCTP_FLAG_SOM, data, 4, 0, &index) ==
+                MCTP_REASM_NO_ROOM, "completed message evicted")) return 1;
+    return 0;
+}
+
+#if MCTP_REASSEMBLY_ENABLED
+/**
+ * @brief Test that multi-packet messages received by mctp_update() are reassembled.
+ *
+ * The packets are absorbed without being reported by
+ * mctp_is_packet_available(); the message is then returned by
+ * mctp_get_message() with its source and tag until released.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_reasm_through_update(void) {
+    uint8_t rx[3 * 40];
+    uint16_t rn = 0;
+    const uint8_t flags[3] = {MCTP_FLAG_SOM | 0x00 | MCTP_FLAG_TO | 2, 0x10 | MCTP_FLAG_TO | 2,
+                              MCTP_FLAG_EOM | 0x20 | MCTP_FLAG_TO | 2};
+    for (int p = 0; p < 3; ++p) {
+        uint8_t* f = &rx[rn];
+        uint16_t n = 0;
+        f[n++] = FRAME_CHAR; f[n++] = 0x01; f[n++] = 4 + 20;
+        f[n++] = 0x01; f[n++] = 0x00; f[n++] = 0x0A; f[n++] = flags[p];
+        for (int k = 0; k < 20; ++k) f[n++] = (uint8_t)(0x10 + 20 * p + k);
+        uint16_t fcs = calc_fcs(0xffff, &f[1], n - 1);
+        f[n++] = (uint8_t)(fcs >> 8); f[n++] = (uint8_t)(fcs & 0xFF); f[n++] = FRAME_CHAR;
+        rn = (uint16_t)(rn + n);
+    }
+    mctp_init();
+    mock_clear_rx();
+    mock_set_rx_buffer(rx, rn);
+    for (int it = 0; (it < 100) && ((mock_rx_remaining() != 0) || mctp_is_packet_available());
+         ++it) {
+        if (require(!mctp_is_packet_available(), "packet of a multi-packet message reported")) {
+            return 1;
+        }
+        mctp_update();
+    }
+    mctp_update();
+    if (require(!mctp_is_packet_available(), "last packet reported")) return 1;
+    if (require(mctp_is_message_available(), "message not reassembled")) return 1;
+    uint16_t len = 0;
+    uint8_t src = 0, tag = 0;
+    const uint8_t* msg = mctp_get_message(&len, &src, &tag);
+    if (require((msg != NULL) && (len == 60), "message length %u", len)) return 1;
+    if (require((src == 0x0A) && (tag == (MCTP_FLAG_TO | 2)), "source %u tag %u", src, tag)) {
+        return 1;
+    }
+    for (int k = 0; k < 60; ++k) {
+        if (require(msg[k] == 0x10 + k, "byte %d wrong", k)) return 1;
+    }
+    mctp_release_message();
+    if (require(!mctp_is_message_available(), "message not released")) return 1;
+    return 0;
+}
+#endif
+
+#if MCTP_FULL_DUPLEX_ENABLED
+/**
+ * @brief Test that a request arriving back to back with the previous one is kept.
+ *
+ * Two Get Endpoint ID requests arrive together while the transmitter only
+ * takes five bytes per main loop iteration.  The second request must be
+ * received while the first response is still on the wire, and both
+ * responses must be sent.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_full_duplex_pipelined(void) {
+    uint8_t req[13] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00, 0x80, 0x02};
+    uint16_t fcs = calc_fcs(0xffff, &req[1], 9);
+    req[10] = (uint8_t)(fcs >> 8); req[11] = (uint8_t)(fcs & 0xFF); req[12] = FRAME_CHAR;
+    uint8_t rx[2 * sizeof(req)];
+    memcpy(rx, req, sizeof(req));
+    memcpy(rx + sizeof(req), req, sizeof(req));
+
+    mctp_init();
+    mock_clear_rx();
+    mock_clear_tx();
+    mock_set_rx_buffer(rx, sizeof(rx));
+    int handled = 0;
+    uint16_t tx_at_second = 0;
+    for (int it = 0; (it < 100) && (handled < 2); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+        if (mctp_is_packet_available()) {
+            if (++handled == 2) tx_at_second = mock_tx_len();
+            mctp_process_control_message();
+        }
+    }
+    if (require(handled == 2, "handled %d requests", handled)) return 1;
+    if (require(tx_at_second < 16, "second request waited for the first response")) return 1;
+    for (int it = 0; it < 100; ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+    int frame_chars = 0;
+    for (uint16_t i = 0; i < mock_tx_len(); ++i) frame_chars += (mock_tx_buffer()[i] == FRAME_CHAR);
+    if (require(frame_chars == 4, "expected two response frames, saw %d framing bytes",
+                frame_chars)) return 1;
+    return 0;
+}
+#endif
+
+#if MCTP_RX_QUEUE_DEPTH
+/**
+ * @brief Test that a burst of requests is queued and answered in order.
+ *
+ * MCTP_RX_QUEUE_DEPTH + 3 Get Endpoint ID requests arrive before the
+ * application handles any of them.  One is handed over in mctp_buffer,
+ * MCTP_RX_QUEUE_DEPTH wait in the queue and the last two are counted as
+ * drops; the kept requests are then handled in arrival order.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_rx_queue_burst(void) {
+    enum { BURST = MCTP_RX_QUEUE_DEPTH + 3 };
+    uint8_t rx[BURST * 13];
+    for (int n = 0; n < BURST; ++n) {
+        uint8_t* req = &rx[13 * n];
+        const uint8_t hdr[10] = {0x7E, 0x01, 0x07, 0x01, 0x00, 0x08, 0xC8, 0x00,
+                                 (uint8_t)(0x80 | n), 0x02};
+        memcpy(req, hdr, sizeof(hdr));
+        uint16_t fcs = calc_fcs(0xffff, &req[1], 9);
+        req[10] = (uint8_t)(fcs >> 8); req[11] = (uint8_t)(fcs & 0xFF); req[12] = FRAME_CHAR;
+    }
+    mctp_init();
+    mock_clear_rx();
+    mock_clear_tx();
+    mock_set_rx_buffer(rx, sizeof(rx));
+    uint32_t drops = mctp_rx_queue_drops();
+    while (mock_rx_remaining() != 0) mctp_update();
+    if (require(mctp_rx_queue_drops() == drops + 2, "%u frames dropped",
+                (unsigned)(mctp_rx_queue_drops() - drops))) return 1;
+    if (require(mctp_rx_queue_high_water() == MCTP_RX_QUEUE_DEPTH, "high water %u",
+                mctp_rx_queue_high_water())) return 1;
+
+    int handled = 0;
+    for (int it = 0; (it < 1000) && (handled <= MCTP_RX_QUEUE_DEPTH); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+        if (mctp_is_packet_available()) {
+            if (require(mctp_buffer[8] == (0x80 | handled), "request %d out of order", handled)) {
+                return 1;
+            }
+            handled++;
+            mctp_process_control_message();
+        }
+    }
+    if (require(handled == MCTP_RX_QUEUE_DEPTH + 1, "handled %d requests", handled)) return 1;
+    return 0;
+}
+#endif
+
+#if MCTP_FRAGMENTATION_ENABLED
+/**
+ * @brief Unescape the next frame on the wire.
+ *
+ * Mirrors the transmitter: bytes [3, byte count + 4) of the frame are
+ * escaped, the rest are sent raw.
+ *
+ * @param tx Transmitted bytes.
+ * @param tx_len Number of transmitted bytes.
+ * @param pos Wire offset of the frame; advanced past it.
+ * @param out Destination for the logical frame.
+ * @return uint16_t Logical frame length, or 0 when no complete frame is left.
+ */
+static uint16_t next_tx_frame(const uint8_t* tx, uint16_t tx_len, uint16_t* pos, uint8_t* out) {
+    uint16_t w = *pos;
+    uint16_t o = 0;
+    if ((uint16_t)(tx_len - w) < 3) return 0;
+    while ((w < tx_len) && ((o < 3) || (o < (uint16_t)(out[2] + 6)))) {
+        uint8_t b = tx[w++];
+        if ((o >= 3) && (o < (uint16_t)(out[2] + 4)) && (b == ESCAPE_CHAR) && (w < tx_len)) {
+            b = (uint8_t)(tx[w++] + 0x20);
+        }
+        out[o++] = b;
+    }
+    *pos = w;
+    return ((o >= 3) && (o == (uint16_t)(out[2] + 6))) ? o : 0;
+}
+
+/**
+ * @brief Check the packets of a sent message and reassemble them.
+ *
+ * @param tag Expected tag owner bit and message tag.
+ * @param expected Message that was sent.
+ * @param len Message length.
+ * @param packets Expected number of packets.
+ * @return int 0 on success, 1 on failure.
+ */
+static int check_sent_message(uint8_t tag, const uint8_t* expected, uint16_t len, int packets) {
+    static mctp_reasm_t r;
+    uint8_t frame[MCTP_BUFFER_SIZE + 8];
+    uint16_t pos = 0;
+    uint16_t offset = 0;
+    uint8_t index = 0xFF;
+    int result = MCTP_REASM_PENDING;
+    mctp_reasm_init(&r);
+    for (int p = 0; p < packets; ++p) {
+        uint16_t n = next_tx_frame(mock_tx_buffer(), mock_tx_len(), &pos, frame);
+        if (require(n != 0, "packet %d missing", p)) return 1;
+        uint8_t bc = frame[2];
+        uint16_t unit = (uint16_t)(mctp_get_transmission_unit() - 4);
+        uint16_t chunk = (uint16_t)((len - offset > unit) ? unit : len - offset);
+        uint8_t flags = (uint8_t)(((p & 3) << 4) | tag | ((p == 0) ? 0x80 : 0) |
+                                  ((p == packets - 1) ? 0x40 : 0));
+        if (require(bc == chunk + 4, "packet %d byte count %u", p, bc)) return 1;
+        if (require((frame[0] == FRAME_CHAR) && (frame[n - 1] == FRAME_CHAR), "framing")) return 1;
+        if (require((frame[4] == 0x10) && (frame[6] == flags), "packet %d flags 0x%02x", p,
+                    frame[6])) return 1;
+        uint16_t fcs = calc_fcs(0xffff, &frame[1], bc + 2);
+        if (require((frame[bc + 3] == (fcs >> 8)) && (frame[bc + 4] == (fcs & 0xFF)),
+                    "packet %d FCS", p)) return 1;
+        result = mctp_reasm_packet(&r, frame[5], frame[6], &frame[7], chunk, 0, &index);
+        offset = (uint16_t)(offset + chunk);
+    }
+    if (require(pos == mock_tx_len(), "extra bytes after the last packet")) return 1;
+    if (require(result == MCTP_REASM_COMPLETE, "message not reassembled (%d)", result)) return 1;
+    uint16_t got = 0;
+    const uint8_t* msg = mctp_reasm_message(&r, index, &got);
+    if (require((msg != NULL) && (got == len), "message length %u", got)) return 1;
+    return require_u8_array_eq(expected, msg, len);
+}
+
+/**
+ * @brief Test that a long message is sent as a sequence of packets.
+ *
+ * A 150-byte message (including bytes that need escaping) is sent through
+ * mctp_update() five bytes at a time and must arrive as three packets with
+ * SOM, EOM and sequence numbers set, each with a valid FCS.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_send_message_fragments(void) {
+    uint8_t msg[150];
+    for (int k = 0; k < 150; ++k) msg[k] = (uint8_t)(7 * k);
+    mctp_init();
+    mock_clear_rx();
+    mock_clear_tx();
+    if (require(mctp_send_message(0x10, 0x03, msg, 0) == -2, "empty message accepted")) return 1;
+    if (require(mctp_send_message(0x10, 0x03, msg, sizeof(msg)) == 0, "send failed")) return 1;
+    if (require(mctp_is_message_sending(), "message not sending")) return 1;
+    if (require(mctp_send_message(0x10, 0x03, msg, sizeof(msg)) == -1, "second message accepted")) {
+        return 1;
+    }
+    for (int it = 0; (it < 1000) && mctp_is_message_sending(); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+    if (require(!mctp_is_message_sending(), "message never finished")) return 1;
+    return check_sent_message(0x03, msg, sizeof(msg), 3);
+}
+
+/**
+ * @brief Test the transmission unit used for sending messages.
+ *
+ * The unit stays within [BASELINE_TRANSMISSION_UNIT, MCTP_TRANSMISSION_UNIT];
+ * when the build allows 250-byte payloads, a 256-byte message is sent as two
+ * packets instead of five.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_transmission_unit(void) {
+    uint8_t msg[256];
+    for (int k = 0; k < 256; ++k) msg[k] = (uint8_t)(3 * k + 1);
+    mctp_init();
+    if (require(mctp_get_transmission_unit() == BASELINE_TRANSMISSION_UNIT, "unit %u",
+                mctp_get_transmission_unit())) return 1;
+    if (require(mctp_set_transmission_unit(BASELINE_TRANSMISSION_UNIT - 1) == -1,
+                "unit below the baseline accepted")) return 1;
+    if (require(mctp_set_transmission_unit(MCTP_TRANSMISSION_UNIT + 1) == -1,
+                "unit above MCTP_TRANSMISSION_UNIT accepted")) return 1;
+    if (require(mctp_set_transmission_unit(MCTP_TRANSMISSION_UNIT) == 0, "unit refused")) return 1;
+    uint16_t payload = (uint16_t)(MCTP_TRANSMISSION_UNIT - 4);
+    mock_clear_rx();
+    mock_clear_tx();
+    if (require(mctp_send_message(0x10, 0x01, msg, sizeof(msg)) == 0, "send failed")) return 1;
+    for (int it = 0; (it < 1000) && mctp_is_message_sending(); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+    if (check_sent_message(0x01, msg, sizeof(msg), (sizeof(msg) + payload - 1) / payload)) return 1;
+    mctp_init();
+    return require(mctp_get_transmission_unit() == BASELINE_TRANSMISSION_UNIT,
+                   "mctp_init() kept the unit");
+}
+
+/**
+ * @brief Message source for test_send_message_callback(): byte k is k ^ 0x5A.
+ */
+static void message_source(void* ctx, uint16_t offset, uint8_t* dst, uint16_t len) {
+    (*(int*)ctx)++;
+    for (uint16_t k = 0; k < len; ++k) dst[k] = (uint8_t)((offset + k) ^ 0x5A);
+}
+
+/**
+ * @brief Test a message produced by a callback, one packet at a time.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_send_message_callback(void) {
+    uint8_t expected[61];
+    int calls = 0;
+    for (int k = 0; k < 61; ++k) expected[k] = (uint8_t)(k ^ 0x5A);
+    mctp_init();
+    mock_clear_rx();
+    mock_clear_tx();
+    if (require(mctp_send_message_cb(0x10, 0x0B, sizeof(expected), message_source, &calls) == 0,
+                "send failed")) return 1;
+    if (require(calls == 0, "message read before transmission")) return 1;
+    for (int it = 0; (it < 1000) && mctp_is_message_sending(); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+    if (require(calls == 2, "source called %d times", calls)) return 1;
+    return check_sent_message(0x0B, expected, sizeof(expected), 2);
+}
+
+/**
+ * @brief Send a message from the default endpoint to an endpoint on a test link.
+ *
+ * The serial output of the fragmenter is delivered, one frame at a time, to
+ * a receiving endpoint driven by mctp_update_ctx().  The message spans at
+ * least one full packet (as many as the reassembly limit allows).  Every
+ * packet must be accepted, including the full ones whose byte count equals
+ * the unit, and
+ * the message must come out whole: reassembled when reassembly is built in,
+ * or as the concatenated packet payloads otherwise.
+ *
+ * @param unit Transmission unit of the sender.
+ * @return int 0 on success, 1 on failure.
+ */
+static int message_end_to_end(uint16_t unit) {
+    static mctp_endpoint_t rx_ep;
+    static struct test_link link;
+    static uint8_t msg[2 * (MCTP_TRANSMISSION_UNIT - 4) + 10];
+    static uint8_t got[sizeof(msg)];
+    uint16_t len = (uint16_t)(2 * (unit - 4) + 10); /* two full packets and a short one */
+#if MCTP_REASSEMBLY_ENABLED
+    if (len > MCTP_REASM_MAX_MESSAGE) len = MCTP_REASM_MAX_MESSAGE;
+#endif
+    const int expected_packets = (len + unit - 5) / (unit - 4);
+    uint16_t got_len = 0;
+    int packets = 0;
+    for (uint16_t k = 0; k < len; ++k) msg[k] = (uint8_t)(7 * k);
+
+    mctp_init();
+    mctp_default_endpoint.endpoint_id = 0x0A;
+    if (require(mctp_set_transmission_unit(unit) == 0, "unit %u refused", unit)) return 1;
+    mock_clear_rx();
+    mock_clear_tx();
+    if (require(mctp_send_message(0x00, MCTP_FLAG_TO | 5, msg, len) == 0, "send failed")) return 1;
+    for (int it = 0; (it < 1000) && mctp_is_message_sending(); ++it) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+    if (require(!mctp_is_message_sending(), "message never finished")) return 1;
+
+    memset(&link, 0, sizeof(link));
+    mctp_init_ctx(&rx_ep, &test_link_ops, &link);
+    const uint8_t* wire = mock_tx_buffer();
+    uint16_t wire_len = mock_tx_len();
+    uint16_t pos = 0;
+    while (pos < wire_len) {
+        uint16_t end = (uint16_t)(pos + 1);
+        while ((end < wire_len) && (wire[end] != FRAME_CHAR)) ++end;
+        uint16_t frame_len = (uint16_t)(end + 1 - pos);
+        if (require((wire[pos] == FRAME_CHAR) && (end < wire_len) && (frame_len <= sizeof(link.rx)),
+                    "malformed output at %u", pos)) return 1;
+#if MCTP_RX_RING_ENABLED
+        (void)mctp_ring_write(&rx_ep.rx_ring, &wire[pos], frame_len);
+#else
+        memcpy(link.rx, &wire[pos], frame_len);
+        link.rx_len = frame_len;
+        link.rx_pos = 0;
+#endif
+        uint8_t byte_count = wire[pos + 2];
+        pos = (uint16_t)(end + 1);
+        ++packets;
+        for (int it = 0; (it < 100) && !mctp_is_packet_available_ctx(&rx_ep); ++it) {
+            mctp_update_ctx(&rx_ep);
+        }
+#if MCTP_REASSEMBLY_ENABLED
+        (void)byte_count;
+        if (require(!mctp_is_packet_available_ctx(&rx_ep), "packet %d not absorbed", packets)) {
+            return 1;
+        }
+#else
+        uint16_t n = 0;
+        uint8_t* payload = mctp_get_request_ctx(&rx_ep, &n);
+        if (require(payload != NULL, "packet %d (byte count %u, unit %u) not received", packets,
+                    byte_count, unit)) return 1;
+        if (require(got_len + n <= len, "too many message bytes")) return 1;
+        memcpy(&got[got_len], payload, n);
+        got_len = (uint16_t)(got_len + n);
+        mctp_ignore_packet_ctx(&rx_ep);
+#endif
+    }
+    if (require(packets == expected_packets, "%d packets for %u bytes at unit %u", packets, len,
+                unit)) return 1;
+#if MCTP_REASSEMBLY_ENABLED
+    uint8_t src = 0, tag = 0;
+    const uint8_t* m = mctp_get_message_ctx(&rx_ep, &got_len, &src, &tag);
+    if (require(m != NULL, "message not reassembled at unit %u", unit)) return 1;
+    if (require((src == 0x0A) && (tag == (MCTP_FLAG_TO | 5)), "source %u tag %u", src, tag)) {
+        return 1;
+    }
+    memcpy(got, m, got_len);
+    mctp_release_message_ctx(&rx_ep);
+#endif
+    if (require(got_len == len, "received %u of %u bytes", got_len, len)) return 1;
+    return require_u8_array_eq(msg, got, len);
+}
+
+/**
+ * @brief Test a fragmented message exchanged between two endpoints.
+ *
+ * Runs message_end_to_end() at the baseline and at the largest transmission
+ * unit of the build.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_send_message_end_to_end(void) {
+    if (message_end_to_end(BASELINE_TRANSMISSION_UNIT)) return 1;
+    if (message_end_to_end(MCTP_TRANSMISSION_UNIT)) return 1;
+    mctp_init();
+    return 0;
+}
+#endif
+
+#if MCTP_EVENT_TX_ENABLED
+
+/**
+ * @brief Test behavior when the event queue fills.
+ *
+ * `MCTP_EVENT_QUEUE_DEPTH` events must be absorbed without loss; the next one
+ * is refused and counted as a drop, and the high-water mark reaches the depth.
+ * All queued events are then transmitted in order.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_slot_full(void) {
+    mctp_init();
+    mock_clear_tx();
+    uint8_t evt_frame[9] = {0x7E, 0x01, 0x02, 0x00, 0x11, 0x22, 0x33, 0x44, 0x7E};
+    uint8_t expected[2 * 9 * MCTP_EVENT_QUEUE_DEPTH];
+    uint16_t en = 0;
+    uint32_t drops = mctp_event_queue_drops();
+    for (int n = 0; n < MCTP_EVENT_QUEUE_DEPTH; ++n) {
+        evt_frame[4] = (uint8_t)(0x20 + n);
+        uint16_t fcs = calc_fcs(0xffff, &evt_frame[1], 4);
+        evt_frame[5] = (uint8_t)(fcs >> 8); evt_frame[6] = (uint8_t)(fcs & 0xFF);
+        if (require(mctp_send_event(evt_frame, 9) == 0, "enqueue %d failed", n)) return 1;
+        for (int k = 0; k < 9; ++k) {
+            uint8_t b = evt_frame[k];
+            if ((k >= 3) && (k <= 5) && ((b == FRAME_CHAR) || (b == ESCAPE_CHAR))) {
+                expected[en++] = ESCAPE_CHAR;
+                b = (uint8_t)(b - 0x20);
+            }
+            expected[en++] = b;
+        }
+    }
+    if (require(mctp_send_event(evt_frame, 9) == -1, "enqueue beyond depth should fail")) return 1;
+    if (require(mctp_event_queue_drops() == drops + 1, "drop not counted")) return 1;
+    if (require(mctp_event_queue_high_water() == MCTP_EVENT_QUEUE_DEPTH, "high water %u",
+                mctp_event_queue_high_water())) return 1;
+    mock_set_can_write(1);
+    while (mctp_send_frame() != 0) mock_set_can_write(1);
+    if (require(mctp_is_event_queue_empty(), "queue not drained")) return 1;
+    if (require(mock_tx_len() == en, "sent %u bytes, expected %u", mock_tx_len(), en)) return 1;
+    if (require_u8_array_eq(expected, mock_tx_buffer(), en)) return 1;
+    return 0;
+}
+
+
+
+/**
+ * @brief Fill `frame` with a `len`-byte event frame tagged with `id`.
+ *
+ * @param frame Destination buffer of at least `len` bytes.
+ * @param len Frame length, at least 7.
+ * @param id Tag stored in the first body byte.
+ */
+static void make_event(uint8_t* frame, uint16_t len, uint8_t id) {
+    memset(frame, 0x11, len);
+    frame[0] = FRAME_CHAR; frame[1] = 0x01; frame[2] = (uint8_t)(len - 6); frame[3] = id;
+    frame[len - 1] = FRAME_CHAR;
+}
+
+/**
+ * @brief Test that variable-length events wrap around the event arena.
+ *
+ * Two 100-byte events leave too little room for a third until the oldest has
+ * been sent; the next allocation then wraps to the start of the arena.  All
+ * events must still go out whole and in order.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_arena_wrap(void) {
+    uint8_t evt[100];
+    mctp_init();
+    mock_clear_tx();
+    make_event(evt, 100, 1);
+    if (require(mctp_send_event(evt, 100) == 0, "event 1 refused")) return 1;
+    make_event(evt, 100, 2);
+    if (require(mctp_send_event(evt, 100) == 0, "event 2 refused")) return 1;
+    make_event(evt, 100, 3);
+    if (require(mctp_send_event(evt, 100) == -1, "event 3 should not fit")) return 1;
+
+    /* send event 1 only; the arena space it held becomes free */
+    while (mock_tx_len() < 100) {
+        mock_set_can_write(0);
+        mctp_send_frame();
+    }
+    if (require(mctp_send_event(evt, 100) == 0, "event 3 refused after wrap")) return 1;
+    make_event(evt, 20, 4);
+    if (require(mctp_send_event(evt, 20) == -1, "event 4 should not fit")) return 1;
+
+    mock_set_can_write(0);
+    while (mctp_send_frame() != 0) mock_set_can_write(0);
+    if (require(mock_tx_len() == 300, "sent %u bytes", mock_tx_len())) return 1;
+    for (int n = 0; n < 3; ++n) {
+        const uint8_t* f = mock_tx_buffer() + 100 * n;
+        if (require((f[0] == FRAME_CHAR) && (f[3] == n + 1) && (f[99] == FRAME_CHAR),
+                    "event %d malformed or out of order", n + 1)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Test zero-copy event submission through reserve/commit.
+ *
+ * The payload is written in place; commit must produce a complete frame
+ * (header, byte count, FCS, trailer) and the reservation must hold its place
+ * ahead of an event queued with mctp_send_event() before the commit.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_reserve_commit(void) {
+    mctp_init();
+    mock_clear_tx();
+    if (require(mctp_event_commit(0x10, 1) == -1, "commit without reservation")) return 1;
+    uint8_t* payload = mctp_event_reserve(4);
+    if (require(payload != NULL, "reserve failed")) return 1;
+    if (require(mctp_event_reserve(4) == NULL, "second reservation allowed")) return 1;
+
+    uint8_t later[9];
+    make_event(later, 9, 0x77);
+    if (require(mctp_send_event(later, 9) == 0, "event behind reservation refused")) return 1;
+    mock_set_can_write(0);
+    mctp_update();
+    if (require(mock_tx_len() == 0, "frames sent before the reservation was committed")) return 1;
+
+    payload[0] = 0x7F; payload[1] = 0x7E; payload[2] = 0x02; payload[3] = 0x03;
+    if (require(mctp_event_commit(0x10, 0x0B) == 0, "commit failed")) return 1;
+    while (!mctp_is_event_queue_empty()) {
+        mock_set_can_write(0);
+        mctp_update();
+    }
+
+    uint8_t out[32];
+    unescape_tx(mock_tx_buffer(), mock_tx_len(), out, sizeof(out));
+    /* the source is whatever EID earlier tests assigned to this endpoint */
+    uint8_t expected[14] = {FRAME_CHAR, 0x01, 8, 0x01, 0x10, out[5], 0xCB, 0x7F, 0x7E, 0x02, 0x03};
+    uint16_t fcs = calc_fcs(0xffff, &expected[1], 10);
+    expected[11] = (uint8_t)(fcs >> 8); expected[12] = (uint8_t)(fcs & 0xFF);
+    expected[13] = FRAME_CHAR;
+    if (require_u8_array_eq(expected, out, sizeof(expected))) return 1;
+    if (require(mock_tx_len() >= 15 + 9, "second event missing")) return 1;
+    const uint8_t* second = mock_tx_buffer() + mock_tx_len() - 9;
+    if (require((second[0] == FRAME_CHAR) && (second[3] == 0x77), "event order wrong")) return 1;
+    return 0;
+}
+
+/**
+ * @brief Test the order of a response competing with queued events.
+ *
+ * Three events are queued before a response is handed over; the position of
+ * the response on the wire follows the compiled MCTP_TX_SCHED policy.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_tx_sched_policy(void) {
+    uint8_t evt[9];
+    mctp_init();
+    mock_clear_tx();
+    for (uint8_t id = 1; id <= 3; ++id) {
+        make_event(evt, 9, id);
+        if (require(mctp_send_event(evt, 9) == 0, "event %u refused", id)) return 1;
+    }
+    make_event(mctp_buffer, 9, 0x55);
+    rxState = MCTPSER_AWAITING_RESPONSE;
+    mock_set_can_write(0);
+    while (mctp_send_frame() != 0) mock_set_can_write(0);
+
+#if MCTP_TX_SCHED == MCTP_TX_SCHED_ROUND_ROBIN
+    const int expected_pos = 0;
+#elif MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE
+    const int expected_pos = (MCTP_TX_RESPONSE_BUDGET / 9 < 3) ? MCTP_TX_RESPONSE_BUDGET / 9 : 3;
+#else
+    const int expected_pos = 3;
+#endif
+    /* the frames contain no bytes that need escaping */
+    const uint8_t* out = mock_tx_buffer();
+    if (require(mock_tx_len() == 36, "sent %u bytes", mock_tx_len())) return 1;
+    uint8_t next_event = 1;
+    for (int pos = 0; pos < 4; ++pos) {
+        uint8_t id = out[9 * pos + 3];
+        if (pos == expected_pos) {
+            if (require(id == 0x55, "response not at position %d", pos)) return 1;
+        } else if (require(id == next_event++, "event out of order at position %d", pos)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Test that an event waits for the current primary frame to finish.
+ *
+ * Ensures event frames are sent as a second frame following the primary.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_waits_for_current_frame(void) {
+    mock_clear_tx(); uint8_t prim[9] = {0x7E,0x01,0x02,0x00,0xAA,0xBB,0xCC,0xDD,0x7E}; uint16_t fcs = calc_fcs(0xffff, &prim[1], 5); prim[5]=(uint8_t)(fcs>>8); prim[6]=(uint8_t)(fcs&0xFF);
+    { uint16_t _len = 9; if (_len > MCTP_BUFFER_SIZE) _len = MCTP_BUFFER_SIZE; for (uint16_t _i=0; _i<_len; ++_i) mctp_buffer[_i]=prim[_i]; if (_len>2) mctp_buffer[2] = (uint8_t)((_len>=6)?(_len-6):0); buffer_idx=_len; rxState = MCTPSER_AWAITING_RESPONSE; }
+    mock_set_can_write(1); mctp_send_frame(); uint8_t evt[9] = {0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; fcs = calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r = mctp_send_event(evt,9); if (require(r==0, "enqueue event failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1);
+    const uint8_t* tx = mock_tx_buffer(); uint16_t txlen = mock_tx_len(); if (require(txlen >= 18, "tx too short")) return 1; if (require(tx[0] == 0x7E, "first frame missing")) return 1; int found=0; for (uint16_t i=1;i<txlen;++i) if (tx[i]==0x7E) { found=1; break; } if (require(found, "second frame not found")) return 1; return 0; }
+
+
+/**
+ * @brief Test event priority when primary is idle.
+ *
+ * With nothing on the wire, an event and a response are ready together; the
+ * frame sent first follows the compiled MCTP_TX_SCHED policy.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_priority_before_primary_when_idle(void) {
+#if MCTP_TX_SCHED == MCTP_TX_SCHED_ROUND_ROBIN
+    const uint8_t first = 0xAA; /* nothing sent since init: the response's turn */
+#elif MCTP_TX_SCHED == MCTP_TX_SCHED_DEADLINE
+    const uint8_t first = (MCTP_TX_RESPONSE_BUDGET >= 9) ? 0x10 : 0xAA;
+#else
+    const uint8_t first = 0x10;
+#endif
+    mctp_init();
+    mock_clear_tx(); uint8_t prim[9]={0x7E,0x01,0x02,0x00,0xAA,0xBB,0xCC,0xDD,0x7E}; uint16_t fcs=calc_fcs(0xffff,&prim[1],5); prim[5]=(uint8_t)(fcs>>8); prim[6]=(uint8_t)(fcs&0xFF);
+    { uint16_t _len=9; if (_len>MCTP_BUFFER_SIZE) _len=MCTP_BUFFER_SIZE; for (uint16_t _i=0;_i<_len;++_i) mctp_buffer[_i]=prim[_i]; if (_len>2) mctp_buffer[2]=(uint8_t)((_len>=6)?(_len-6):0); buffer_idx=_len; rxState=MCTPSER_AWAITING_RESPONSE; }
+    uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue event failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); const uint8_t* tx=mock_tx_buffer(); if (require(tx[0]==0x7E,"first byte not frame")) return 1; uint8_t out[64]; uint16_t out_len = unescape_tx(tx, mock_tx_len(), out, sizeof(out)); (void)out_len; if (require(out[4]==first, "first frame destination mismatch")) return 1; return 0; }
+
+
+/**
+ * @brief Test event queue is empty initially.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_queue_empty_initial(void) { mock_clear_tx(); if (require(mctp_is_event_queue_empty() == 1, "event queue not empty initially")) return 1; return 0; }
+
+
+/**
+ * @brief Test event queue is non-empty after enqueue.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_queue_not_empty_after_enqueue(void) { mock_clear_tx(); uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; uint16_t fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue failed")) return 1; if (require(mctp_is_event_queue_empty() == 0, "queue still empty after enqueue")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); return 0; }
+
+
+/**
+ * @brief Test event queue empties after transmit.
+ *
+ * @return int 0 on success, 1 on failure.
+ */
+int test_event_queue_empty_after_transmit(void) { mock_clear_tx(); uint8_t evt[9]={0x7E,0x01,0x02,0x00,0x10,0x20,0x30,0x40,0x7E}; uint16_t fcs=calc_fcs(0xffff,&evt[1],5); evt[5]=(uint8_t)(fcs>>8); evt[6]=(uint8_t)(fcs&0xFF); int r=mctp_send_event(evt,9); if (require(r==0,"enqueue failed")) return 1; mock_set_can_write(1); while (mctp_send_frame() != 0) mock_set_can_write(1); if (require(mctp_is_event_queue_empty() == 1, "queue not empty after transmit")) return 1; return 0; }
+#endif
 
 /* Test registration and runner */
 typedef int (*test_fn_t)(void);
@@ -856,8 +2649,18 @@ static struct test_entry tests[] = {
     {"test_calc_fcs_known", test_calc_fcs_known},
     {"test_send_frame_escape_and_resume", test_send_frame_escape_and_resume},
     {"test_send_frame_reentrancy", test_send_frame_reentrancy},
+    {"test_send_frame_bulk_runs", test_send_frame_bulk_runs},
     {"test_validate_rx_valid", test_validate_rx_valid},
     {"test_validate_rx_bad_fcs", test_validate_rx_bad_fcs},
+    {"test_rx_eof_latency", test_rx_eof_latency},
+    {"test_rx_transmission_unit_boundary", test_rx_transmission_unit_boundary},
+    {"test_rx_bulk_chunk", test_rx_bulk_chunk},
+    {"test_rx_sync_hunt", test_rx_sync_hunt},
+#if !MCTP_RX_QUEUE_DEPTH
+    /* compares mctp_update() with mctp_rx_byte() in mctp_buffer, where queued frames never land */
+    {"test_rx_bulk_unescape_differential", test_rx_bulk_unescape_differential},
+    {"test_rx_bulk_bad_length", test_rx_bulk_bad_length},
+#endif
     {"test_control_rx_bad_fcs", test_control_rx_bad_fcs},
     {"test_init_and_helpers", test_init_and_helpers},
     {"test_control_get_endpoint_id", test_control_get_endpoint_id},
@@ -866,6 +2669,14 @@ static struct test_entry tests[] = {
     {"test_control_get_message_type_support", test_control_get_message_type_support},
     {"test_control_get_mctp_version_support", test_control_get_mctp_version_support},
     {"test_control_unsupported_command", test_control_unsupported_command},
+    {"test_control_dispatch_table", test_control_dispatch_table},
+    {"test_control_response_fcs", test_control_response_fcs},
+    {"test_endpoint_contexts", test_endpoint_contexts},
+#if !MCTP_RX_RING_ENABLED
+    {"test_linux_pty_loopback", test_linux_pty_loopback},
+#endif
+    {"test_uart_model_latency", test_uart_model_latency},
+    {"test_uart_model_rx_overrun", test_uart_model_rx_overrun},
     {"test_control_sequence_tag_instance", test_control_sequence_tag_instance},
     {"test_endpoint_eid_acceptance", test_endpoint_eid_acceptance},
     {"test_rx_escape_end_payload", test_rx_escape_end_payload},
@@ -874,15 +2685,44 @@ static struct test_entry tests[] = {
     {"test_rx_buffer_boundary_reject", test_rx_buffer_boundary_reject},
     {"test_malformed_too_short", test_malformed_too_short},
     {"test_malformed_bad_length_field", test_malformed_bad_length_field},
+    {"test_malformed_zero_length", test_malformed_zero_length},
     {"test_malformed_missing_trailer", test_malformed_missing_trailer},
     {"test_malformed_truncated_fcs", test_malformed_truncated_fcs},
     {"test_calc_fcs_concat_property", test_calc_fcs_concat_property},
+    {"test_calc_fcs_matches_bitwise", test_calc_fcs_matches_bitwise},
+    {"test_calc_fcs_clmul_equivalence", test_calc_fcs_clmul_equivalence},
     {"test_control_set_endpoint_id_reset_and_discovery", test_control_set_endpoint_id_reset_and_discovery},
     {"test_control_get_mctp_version_support_ff_and_unsupported", test_control_get_mctp_version_support_ff_and_unsupported},
+    {"test_ring_wrap_and_overflow", test_ring_wrap_and_overflow},
+    {"test_ring_spsc_stress", test_ring_spsc_stress},
+#if MCTP_RX_RING_ENABLED
+    {"test_ring_update_frames", test_ring_update_frames},
+#endif
     
     
+    {"test_reasm_in_order", test_reasm_in_order},
+    {"test_reasm_sequence_error", test_reasm_sequence_error},
+    {"test_reasm_timeout_and_eviction", test_reasm_timeout_and_eviction},
+#if MCTP_REASSEMBLY_ENABLED
+    {"test_reasm_through_update", test_reasm_through_update},
+#endif
+#if MCTP_FULL_DUPLEX_ENABLED
+    {"test_full_duplex_pipelined", test_full_duplex_pipelined},
+#endif
+#if MCTP_RX_QUEUE_DEPTH
+    {"test_rx_queue_burst", test_rx_queue_burst},
+#endif
+#if MCTP_FRAGMENTATION_ENABLED
+    {"test_send_message_fragments", test_send_message_fragments},
+    {"test_send_message_callback", test_send_message_callback},
+    {"test_send_message_end_to_end", test_send_message_end_to_end},
+    {"test_transmission_unit", test_transmission_unit},
+#endif
 #if MCTP_EVENT_TX_ENABLED
     {"test_event_slot_full", test_event_slot_full},
+    {"test_event_arena_wrap", test_event_arena_wrap},
+    {"test_event_reserve_commit", test_event_reserve_commit},
+    {"test_tx_sched_policy", test_tx_sched_policy},
     {"test_event_waits_for_current_frame", test_event_waits_for_current_frame},
     {"test_event_priority_before_primary_when_idle", test_event_priority_before_primary_when_idle},
     {"test_event_queue_empty_initial", test_event_queue_empty_initial},
@@ -911,6 +2751,10 @@ int main(void) {
     for (int i = 0; i < ntests; ++i) {
         printf("RUNNING %s...\n", tests[i].name);
         last_failure_msg[0] = '\0'; last_failure_file = NULL; last_failure_line = 0;
+#if MCTP_FULL_DUPLEX_ENABLED || MCTP_RX_QUEUE_DEPTH
+        /* a received frame left held by the previous test would block the receiver */
+        mctp_init();
+#endif
         int r = tests[i].fn();
         if (r != 0) {
             printf("FAILED %s: %s (%s:%d)\n", tests[i].name, last_failure_msg, last_failure_file ? last_failure_file : "?", last_failure_line);